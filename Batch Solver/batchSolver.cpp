@@ -0,0 +1,430 @@
+/**
+ * Resident batch mode for the solvers of this repository.
+ *
+ * Running one program per instance costs a process launch and a file open, and for small
+ * instances both take far longer than the solving. batchSolver stays up instead: it reads a
+ * stream of instances, one per line, from a manifest file, from stdin or from the clients of a
+ * Unix socket, solves them on a thread pool and streams one result line per instance back, in
+ * the order the instances arrived.
+ *
+ * An instance is the solver's name followed by its input, either inline (the numbers of the
+ * solver's input file; braces and commas are optional) or as @file references to input files
+ * in any format the program itself reads, binary included:
+ *   mcm {{5, 10}, {10, 3}, {3, 12}}          the (rows, cols) of every matrix
+ *   knapsack {10, {60, 5, 1}, {50, 3, 2}}    the capacity, then (value, weight, count) per brick
+ *   select {3, {7, 10, 4, 3, 20}}            the rank k, then the array
+ *   strassen 2 2 2 {1, 2, 3, 4} {5, 6, 7, 8} rows of A, cols of A (= rows of B), cols of B, then A and B row-major
+ *   mcm @chain.txt
+ *   strassen @matrixA.txt @matrixB.txt
+ * Blank lines and lines starting with '#' are skipped. A result is the answer the matching
+ * program prints - the minimum number of multiplications, the maximum profit, the k-th smallest
+ * element, the sum of the entries of A * B (int32 entries, as strassen's default) - or a line
+ * starting with "Error:" when the instance is invalid. A 0/1 knapsack whose branch and bound
+ * search runs out of time (--time-limit, 1 second per instance by default) gives "N (at most M)":
+ * the best profit found and the proven bound on the optimum.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BATCH_HAVE_UNIX_SOCKETS 1
+#include <cerrno>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "../Common/fastInput.h"
+#include "../Common/threadPool.h"
+#include "../Divide and Conquer/Strassen's Algorithm/matrixFile.h"
+#include "../Divide and Conquer/Strassen's Algorithm/productReductions.h"
+#include "../Dynamic Programming/Dynamic Programming - Knapsack Problem/knapsack.h"
+#include "../Dynamic Programming/Dynamic Programming - Knapsack Problem/knapsackStrategies.h"
+#include "../Dynamic Programming/Dynamic Programming - Matrix Chain Multiplication/matrixChain.h"
+#include "../Selection/Deterministic Order Selection/deterministicSelection.h"
+
+using namespace std;
+
+// Results a stream may have outstanding (queued, being solved or waiting for an earlier one) before reading pauses
+const size_t BATCH_MAX_IN_FLIGHT = 4096;
+// Default time budget of a knapsack's branch and bound, in seconds: far below the standalone
+// program's, since one slow instance holds up the results of every instance behind it
+const double BATCH_KNAPSACK_SECONDS = 1.0;
+
+// Time budget of each knapsack's branch and bound; set by main before any instance is solved
+double knapsackSeconds = BATCH_KNAPSACK_SECONDS;
+
+// --- Instance Parsing ---
+
+string_view trim(string_view text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == string_view::npos) return {};
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+//Removes the first whitespace-separated word from 'text' and returns it
+string_view takeWord(string_view &text) {
+    text = trim(text);
+    size_t end = min(text.find_first_of(" \t"), text.size());
+    string_view word = text.substr(0, end);
+    text = trim(text.substr(end));
+    return word;
+}
+
+//The integers written inline in 'input', or those of the file it references as "@file"
+vector<int64_t> readNumbers(string_view input) {
+    vector<int64_t> numbers;
+    if (!input.empty() && input[0] == '@') {
+        string error;
+        if (!readIntegerList(string(trim(input.substr(1))), numbers, error)) throw runtime_error("Error: " + error + ".");
+        return numbers;
+    }
+    IntegerScanner scanner(input.data(), input.data() + input.size());
+    int64_t value;
+    while (scanner.next(value)) numbers.push_back(value);
+    if (scanner.overflowed()) throw runtime_error("Error: The number at character " + to_string(scanner.overflowOffset()) + " is out of range.");
+    return numbers;
+}
+
+// --- Solvers ---
+
+//Minimum number of scalar multiplications for the chain
+string solveChain(string_view input) {
+    vector<int> P;
+    string error;
+    if (!chainDimensions(readNumbers(input), P, error)) throw runtime_error("Error: " + error + ".");
+    return to_string(matrixChainOrder(P));
+}
+
+//Maximum profit of the knapsack; brick i may be taken up to its count times (negative: any number of times)
+string solveKnapsack(string_view input) {
+    vector<int64_t> numbers = readNumbers(input);
+    int64_t capacity = 0;
+    vector<pair<int, int>> bricks;
+    vector<int> counts;
+    string error;
+    if (!knapsackInput(numbers, capacity, bricks, counts, error)) throw runtime_error("Error: " + error + ".");
+    if ((numbers.size() - 1) % 3 != 0) throw runtime_error("Error: Every brick needs a value, a weight and a count.");
+    if (bricks.empty()) throw runtime_error("Error: There are no bricks.");
+    if (all_of(counts.begin(), counts.end(), [](int count) { return count == 1; })) {
+        //The 0/1 knapsack picks its own strategy; a search cut short by the time limit also gives its bound
+        KnapsackAnswer answer = adaptiveKnapsack(capacity, bricks, knapsackSeconds);
+        if (answer.optimal()) return to_string(answer.profit);
+        return to_string(answer.profit) + " (at most " + to_string(answer.bound) + ")";
+    }
+    //The weight-indexed table is checked before it is allocated: a resident server must not try a 16 GB row
+    if (capacity > KNAPSACK_MAX_TABLE) {
+        throw runtime_error("Error: Bounded knapsacks support capacities up to " + to_string(KNAPSACK_MAX_TABLE) + ".");
+    }
+    bool wide = knapsackNeedsInt64((int)capacity, bricks, counts);
+    return to_string(wide ? boundedKnapsack<int64_t>((int)capacity, bricks, counts) : boundedKnapsack((int)capacity, bricks, counts));
+}
+
+//k-th smallest element of the array
+string solveSelection(string_view input) {
+    vector<int64_t> numbers = readNumbers(input);
+    if (numbers.size() < 2) throw runtime_error("Error: Expected the rank k followed by a non-empty array.");
+    vector<int> data;
+    int64_t k = 0;
+    string error;
+    if (!selection_input(numbers, k, data, error)) throw runtime_error("Error: " + error + ".");
+    if (k <= 0 || k > (int64_t)data.size()) {
+        throw runtime_error("Error: Invalid rank k (" + to_string(k) + "). Must be between 1 and " + to_string(data.size()) + ".");
+    }
+    return to_string(introselect(data, 0, (int)data.size() - 1, (int)k));
+}
+
+//Sum of the entries of A * B, fused from A and B as strassen does by default
+string solveProductSum(string_view input) {
+    Matrix<int32_t> A, B;
+    if (!input.empty() && input[0] == '@') {
+        // "@fileA @fileB"; the names themselves may contain spaces
+        size_t split = input.find(" @");
+        if (split == string_view::npos) throw runtime_error("Error: Expected two matrix files, @fileA @fileB.");
+        string fileA(trim(input.substr(1, split - 1))), fileB(trim(input.substr(split + 2)));
+        A = readMatrixFromFile<int32_t>(fileA);
+        B = readMatrixFromFile<int32_t>(fileB);
+        if (A.empty() || B.empty()) throw runtime_error("Error: Could not read " + (A.empty() ? fileA : fileB) + ".");
+    } else {
+        vector<int64_t> numbers = readNumbers(input);
+        auto dimension = [](int64_t d) { return d > 0 && d <= INT32_MAX; };
+        if (numbers.size() < 3 || !dimension(numbers[0]) || !dimension(numbers[1]) || !dimension(numbers[2])) {
+            throw runtime_error("Error: Expected the dimensions m k n (1 to " + to_string(INT32_MAX) + ") before the entries of A (m x k) and B (k x n).");
+        }
+        int m = (int)numbers[0], k = (int)numbers[1], n = (int)numbers[2];
+        size_t sizeA = (size_t)m * k, sizeB = (size_t)k * n;
+        if (numbers.size() != 3 + sizeA + sizeB) {
+            throw runtime_error("Error: A " + to_string(m) + "x" + to_string(k) + " and a " + to_string(k) + "x" + to_string(n) +
+                                " matrix need " + to_string(sizeA + sizeB) + " entries but " + to_string(numbers.size() - 3) + " were given.");
+        }
+        A = Matrix<int32_t>(m, k);
+        B = Matrix<int32_t>(k, n);
+        // Entries are int32, as strassen's default type, and out-of-range ones are rejected as the file readers do
+        for (size_t i = 3; i < numbers.size(); ++i) {
+            if (numbers[i] < INT32_MIN || numbers[i] > INT32_MAX) {
+                throw runtime_error("Error: Entry " + to_string(i - 2) + " (" + to_string(numbers[i]) + ") does not fit in int32.");
+            }
+        }
+        for (size_t i = 0; i < sizeA; ++i) A.data[i] = (int32_t)numbers[3 + i];
+        for (size_t i = 0; i < sizeB; ++i) B.data[i] = (int32_t)numbers[3 + sizeA + i];
+    }
+    if (A.cols != B.rows) {
+        throw runtime_error("Error: A is " + to_string(A.rows) + "x" + to_string(A.cols) + " but B is " + to_string(B.rows) + "x" +
+                            to_string(B.cols) + ", so they cannot be multiplied.");
+    }
+    return to_string(productSum<int32_t>(A.view(), B.view()));
+}
+
+using InstanceSolver = string (*)(string_view);
+
+//Solver for the name an instance starts with, or nullptr
+InstanceSolver findSolver(string_view name) {
+    if (name == "strassen") return solveProductSum;
+    if (name == "mcm") return solveChain;
+    if (name == "knapsack") return solveKnapsack;
+    if (name == "select") return solveSelection;
+    return nullptr;
+}
+
+//Result line for one instance line
+string solveInstance(string_view line) {
+    string_view input = line;
+    string_view name = takeWord(input);
+    InstanceSolver solver = findSolver(name);
+    if (solver == nullptr) return "Error: Unknown solver '" + string(name) + "'. Use strassen, mcm, knapsack or select.";
+    try {
+        return solver(input);
+    } catch (const runtime_error &e) {
+        return e.what();
+    } catch (const exception &e) {
+        return string("Error: ") + e.what();
+    }
+}
+
+// --- Streams ---
+
+/**
+ * @brief Writes the results of one stream in input order while they are being solved out of
+ * order. A result that finishes early waits until every earlier one has been written, and the
+ * output is flushed each time it catches up, so a client that sends one instance and waits
+ * gets its answer at once.
+ */
+class ResultWriter {
+public:
+    explicit ResultWriter(ostream &output) : out(output) {}
+
+    //Index of the next result, once fewer than BATCH_MAX_IN_FLIGHT are outstanding
+    size_t reserve() {
+        unique_lock<mutex> lock(writeMutex);
+        room.wait(lock, [this] { return issued - written < BATCH_MAX_IN_FLIGHT; });
+        return issued++;
+    }
+
+    void deliver(size_t index, string result) {
+        lock_guard<mutex> lock(writeMutex);
+        ready.emplace(index, move(result));
+        while (!ready.empty() && ready.begin()->first == written) {
+            out << ready.begin()->second << '\n';
+            ready.erase(ready.begin());
+            ++written;
+        }
+        if (written == issued) out.flush();
+        room.notify_one();
+    }
+
+private:
+    ostream &out;
+    mutex writeMutex;
+    condition_variable room;
+    map<size_t, string> ready;
+    size_t issued = 0;
+    size_t written = 0;
+};
+
+//Solves every instance of 'in' on 'pool' (or on this thread when it is null) and writes the results to 'out'
+void processStream(istream &in, ostream &out, ThreadPool* pool) {
+    ResultWriter writer(out);
+    string line;
+    if (pool == nullptr) {
+        while (getline(in, line)) {
+            string_view text = trim(line);
+            if (text.empty() || text[0] == '#') continue;
+            writer.deliver(writer.reserve(), solveInstance(text));
+        }
+        return;
+    }
+    TaskGroup group(*pool);
+    while (getline(in, line)) {
+        string_view text = trim(line);
+        if (text.empty() || text[0] == '#') continue;
+        size_t index = writer.reserve();
+        group.run([&writer, index, instance = string(text)] { writer.deliver(index, solveInstance(instance)); });
+    }
+    group.wait();
+}
+
+#ifdef BATCH_HAVE_UNIX_SOCKETS
+/**
+ * @brief Stream buffer over a socket, so a client connection is read and written like any
+ * other stream.
+ */
+class SocketBuffer : public streambuf {
+public:
+    explicit SocketBuffer(int socket) : fd(socket) {
+        setg(input, input, input);
+        setp(output, output + sizeof(output));
+    }
+
+    ~SocketBuffer() override { sync(); }
+
+protected:
+    int_type underflow() override {
+        ssize_t received;
+        do {
+            received = read(fd, input, sizeof(input));
+        } while (received < 0 && errno == EINTR);
+        if (received <= 0) return traits_type::eof();
+        setg(input, input, input + received);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    int_type overflow(int_type c) override {
+        if (sync() != 0) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        const char* next = pbase();
+        while (next < pptr()) {
+            ssize_t sent = write(fd, next, pptr() - next);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return -1;
+            next += sent;
+        }
+        setp(output, output + sizeof(output));
+        return 0;
+    }
+
+private:
+    int fd;
+    char input[1 << 16];
+    char output[1 << 16];
+};
+
+//Accepts clients on the Unix socket 'path' until the process is stopped; each client is a stream of its own
+int serveSocket(const string &path, ThreadPool* pool) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        cerr << "Error: The socket path " << path << " is too long." << endl;
+        return 1;
+    }
+    strcpy(address.sun_path, path.c_str());
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) {
+        cerr << "Error: Could not create a socket (" << strerror(errno) << ")." << endl;
+        return 1;
+    }
+    // A socket file left behind by an earlier run would make bind fail
+    unlink(path.c_str());
+    if (bind(server, (const sockaddr*)&address, sizeof(address)) != 0 || listen(server, SOMAXCONN) != 0) {
+        cerr << "Error: Could not listen on " << path << " (" << strerror(errno) << ")." << endl;
+        close(server);
+        return 1;
+    }
+    // A client that hangs up early must not take the server down with it
+    signal(SIGPIPE, SIG_IGN);
+    cerr << "Listening on " << path << endl;
+
+    while (true) {
+        int client = accept(server, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            cerr << "Error: Could not accept a client (" << strerror(errno) << ")." << endl;
+            close(server);
+            return 1;
+        }
+        // The clients' instances share the pool; with no pool each client is solved on its own thread
+        thread([client, pool] {
+            {
+                SocketBuffer buffer(client);
+                istream in(&buffer);
+                ostream out(&buffer);
+                processStream(in, out, pool);
+            }
+            close(client);
+        }).detach();
+    }
+}
+#endif
+
+//Usage: batchSolver [--threads N] [--time-limit S] [manifest | -]
+//       batchSolver [--threads N] [--time-limit S] --socket PATH
+//Solves the instances of the manifest (or of stdin when it is missing or "-") and writes one result per
+//line to stdout. --socket serves every client of a Unix socket the same way until the process is stopped.
+//--threads N solves N instances at a time (default: one per hardware thread); the reading thread only
+//reads, so all N are pool workers. --time-limit S caps each knapsack's branch and bound at S seconds.
+//Build with -pthread, e.g. g++ -O2 -std=c++17 -pthread batchSolver.cpp -o batchSolver
+int main(int argc, char* argv[]) {
+    ios::sync_with_stdio(false);
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    string manifest = "-";
+    string socketPath;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            int count = 0;
+            if (!parseNumber(argv[++i], count)) return badFlagValue(arg, argv[i]);
+            threads = max(1, count);
+        }
+        else if (arg == "--time-limit" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], knapsackSeconds)) return badFlagValue(arg, argv[i]);
+        }
+        else if (arg == "--socket" && i + 1 < argc) socketPath = argv[++i];
+        else manifest = arg;
+    }
+
+    unique_ptr<ThreadPool> pool;
+    if (threads > 1) pool = make_unique<ThreadPool>(threads);
+
+    if (!socketPath.empty()) {
+#ifdef BATCH_HAVE_UNIX_SOCKETS
+        return serveSocket(socketPath, pool.get());
+#else
+        cerr << "Error: Unix sockets are not available on this system; pipe the instances to stdin instead." << endl;
+        return 1;
+#endif
+    }
+
+    if (manifest == "-") {
+        processStream(cin, cout, pool.get());
+        return 0;
+    }
+    ifstream file(manifest);
+    if (!file) {
+        cerr << "Error: Could not open the manifest " << manifest << "." << endl;
+        return 1;
+    }
+    processStream(file, cout, pool.get());
+    return 0;
+}
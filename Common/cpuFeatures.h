@@ -0,0 +1,97 @@
+/**
+ * Runtime CPU feature detection for the SIMD kernels in this repository.
+ *
+ * Kernels that use AVX2 / AVX-512 are compiled with per-function target attributes, so the
+ * programs still build with plain "g++ -O2" and run on any x86-64 machine. The kernel to use
+ * is picked once at runtime from cpuFeatures(). On other compilers or architectures
+ * ALGORITHMS_X86_SIMD is not defined and only the scalar kernels are built.
+ *
+ * Most kernels are one loop nest that only needs the compiler to vectorize it for the right
+ * instruction set. Such a loop is written once as an always_inline "body" function, and
+ * SimdKernel<body> instantiates it inside a plain, an AVX2 and an AVX-512 function. Inlined into
+ * each of them, the body is vectorized for that target. select() returns the best of the three
+ * that this machine runs.
+ *
+ * Setting the environment variable ALGORITHMS_SIMD to "scalar", "avx2" or "avx512" caps the
+ * instruction set that is reported, which is handy for comparing kernels on one machine.
+*/
+
+#ifndef COMMON_CPU_FEATURES_H
+#define COMMON_CPU_FEATURES_H
+
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ALGORITHMS_X86_SIMD 1
+#include <immintrin.h>
+#define ALGORITHMS_TARGET(isa) __attribute__((target(isa)))
+//Instruction sets of the two SIMD levels, matching what detectCpuFeatures() checks for
+#define ALGORITHMS_AVX2 "avx2,fma"
+#define ALGORITHMS_AVX512 "avx512f,avx512dq,avx512bw,avx512vl,avx2,fma"
+#endif
+
+struct CpuFeatures {
+    bool avx2 = false;
+    bool avx512 = false; // AVX-512 Foundation plus the DQ/BW/VL extensions the kernels rely on
+};
+
+inline CpuFeatures detectCpuFeatures() {
+    CpuFeatures features;
+#ifdef ALGORITHMS_X86_SIMD
+    __builtin_cpu_init();
+    features.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    features.avx512 = features.avx2 && __builtin_cpu_supports("avx512f") &&
+                      __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512bw") &&
+                      __builtin_cpu_supports("avx512vl");
+#endif
+
+    const char* cap = std::getenv("ALGORITHMS_SIMD");
+    if (cap != nullptr) {
+        if (std::strcmp(cap, "scalar") == 0) {
+            features.avx2 = false;
+            features.avx512 = false;
+        } else if (std::strcmp(cap, "avx2") == 0) {
+            features.avx512 = false;
+        }
+    }
+    return features;
+}
+
+//Detected once, on first use
+inline const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+/**
+ * @brief Scalar, AVX2 and AVX-512 builds of the always_inline function Body, plus select(),
+ * which returns the best one for this machine as a plain function pointer. ScalarBody replaces
+ * Body in the scalar build when the vectorized formulation would be slower without SIMD.
+ */
+template <auto Body, auto ScalarBody = Body, typename Signature = std::remove_pointer_t<decltype(Body)>>
+struct SimdKernel;
+
+template <auto Body, auto ScalarBody, typename Result, typename... Args>
+struct SimdKernel<Body, ScalarBody, Result(Args...)> {
+    using Kernel = Result (*)(Args...);
+
+    static Result scalar(Args... args) { return ScalarBody(args...); }
+#ifdef ALGORITHMS_X86_SIMD
+    ALGORITHMS_TARGET(ALGORITHMS_AVX2)
+    static Result avx2(Args... args) { return Body(args...); }
+    ALGORITHMS_TARGET(ALGORITHMS_AVX512)
+    static Result avx512(Args... args) { return Body(args...); }
+#endif
+
+    static Kernel select() {
+#ifdef ALGORITHMS_X86_SIMD
+        if (cpuFeatures().avx512) return avx512;
+        if (cpuFeatures().avx2) return avx2;
+#endif
+        return scalar;
+    }
+};
+
+#endif
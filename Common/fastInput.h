@@ -0,0 +1,439 @@
+/**
+ * Fast input shared by the programs in this repository.
+ *
+ * MappedFile maps an input file into memory (falling back to reading it on systems without mmap),
+ * so large inputs are parsed straight from the page cache without copying them into a string.
+ *
+ * IntegerScanner walks the mapped text and returns one integer after another. Everything that
+ * is not part of a number - whitespace, commas, braces - is a delimiter; braces are also
+ * counted, so callers that care about {...} grouping (rows of a matrix, for example) can tell
+ * where one group ends and the next begins. Delimiters are classified sixteen bytes at a time
+ * with SSE2 and digits are converted eight at a time with a few multiplies (SWAR), so no
+ * intermediate strings are built the way the stringstream-based readers used to. A number too
+ * large for int64_t stops the scan, and the scanner tells where it starts (see overflowed()).
+ *
+ * Every program also reads a compact binary format: an 8-byte magic "ALGOBIN1", the element
+ * type and rank as uint32, the dimensions as uint64, then the elements in row-major order
+ * (native byte order). The text "{1, 2, 3}" and a rank-1 int32 array {1, 2, 3} are the same
+ * input to every program; a matrix is a rank-2 array. writeBinaryArray produces such files.
+ *
+ * parseNumber checks the numbers given to the programs' command-line flags.
+*/
+
+#ifndef COMMON_FAST_INPUT_H
+#define COMMON_FAST_INPUT_H
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ALGORITHMS_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// --- Memory-Mapped Files ---
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& filename) { open(filename); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    //Maps the whole file read-only. Returns false if it cannot be opened.
+    bool open(const std::string& filename) {
+        close();
+#ifdef ALGORITHMS_HAVE_MMAP
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        length = (size_t)info.st_size;
+        if (length > 0) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                return false;
+            }
+            // Inputs are parsed front to back, so ask for aggressive read-ahead
+            madvise(mapped, length, MADV_SEQUENTIAL);
+            mapping = (const char*)mapped;
+        }
+        ::close(fd);
+        opened = true;
+        return true;
+#else
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) return false;
+        fallback.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        mapping = fallback.data();
+        length = fallback.size();
+        opened = true;
+        return true;
+#endif
+    }
+
+    void close() {
+#ifdef ALGORITHMS_HAVE_MMAP
+        if (mapping != nullptr) munmap((void*)mapping, length);
+#else
+        fallback.clear();
+#endif
+        mapping = nullptr;
+        length = 0;
+        opened = false;
+    }
+
+    bool isOpen() const { return opened; }
+    const char* data() const { return mapping; }
+    const char* end() const { return mapping + length; }
+    size_t size() const { return length; }
+
+private:
+    const char* mapping = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifndef ALGORITHMS_HAVE_MMAP
+    std::vector<char> fallback;
+#endif
+};
+
+// --- Integer Scanner ---
+
+/**
+ * @brief Returns the integers (or, with nextReal, decimal numbers) of a text one by one.
+ * After each call opened() / closed() tell how many '{' / '}' were skipped on the way to the
+ * number just returned, and depth() is the brace nesting at that number.
+ */
+class IntegerScanner {
+public:
+    IntegerScanner(const char* begin, const char* end) : first(begin), pos(begin), stop(end) {}
+
+    //Reads the next integer. Returns false when no number is left, or when the next one does not
+    //fit in int64_t (overflowed() then tells it apart from the end of the text).
+    bool next(int64_t& value) {
+        while (skipToCandidate(false)) {
+            const char* start = pos;
+            bool negative = false;
+            if (*pos == '-' || *pos == '+') {
+                negative = *pos == '-';
+                ++pos;
+            }
+            if (pos == stop || !isDigit(*pos)) continue; // A lone sign is just another delimiter
+            uint64_t magnitude;
+            if (!parseDigits(magnitude) || magnitude > (uint64_t)INT64_MAX + negative) {
+                overflowAt = start;
+                return false;
+            }
+            value = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+            return true;
+        }
+        return false;
+    }
+
+    //Reads the next number that may have a fraction and exponent. Returns false when no number is left.
+    bool nextReal(double& value) {
+        while (skipToCandidate(true)) {
+            const char* start = pos;
+            if (*start == '+') ++start; // from_chars does not accept a leading '+'
+            std::from_chars_result result = std::from_chars(start, stop, value);
+            if (result.ec == std::errc::invalid_argument) {
+                pos = start + 1;
+                continue;
+            }
+            if (result.ec == std::errc::result_out_of_range) {
+                overflowAt = pos;
+                return false;
+            }
+            pos = result.ptr;
+            return true;
+        }
+        return false;
+    }
+
+    int opened() const { return openedSince; }
+    int closed() const { return closedSince; }
+    int depth() const { return nesting; }
+
+    //True once next() or nextReal() stopped at a number out of range; overflowOffset() is its byte offset
+    bool overflowed() const { return overflowAt != nullptr; }
+    size_t overflowOffset() const { return (size_t)(overflowAt - first); }
+
+private:
+    static bool isDigit(char c) { return (unsigned)(c - '0') < 10u; }
+
+    //Moves to the next character that can start a number, counting the braces passed on the way
+    bool skipToCandidate(bool real) {
+        openedSince = closedSince = 0;
+        while (pos < stop) {
+#if defined(__SSE2__)
+            if (stop - pos >= 16) {
+                __m128i chunk = _mm_loadu_si128((const __m128i*)pos);
+                __m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8('0'));
+                __m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(9)), shifted);
+                __m128i signs = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('-')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('+')));
+                __m128i braces = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('{')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('}')));
+                __m128i interesting = _mm_or_si128(_mm_or_si128(digits, signs), braces);
+                if (real) interesting = _mm_or_si128(interesting, _mm_cmpeq_epi8(chunk, _mm_set1_epi8('.')));
+                unsigned mask = (unsigned)_mm_movemask_epi8(interesting);
+                if (mask == 0) {
+                    pos += 16; // Sixteen delimiters in a row
+                    continue;
+                }
+                pos += __builtin_ctz(mask);
+            }
+#endif
+            char c = *pos;
+            if (c == '{') {
+                ++openedSince;
+                ++nesting;
+            } else if (c == '}') {
+                ++closedSince;
+                --nesting;
+            } else if (isDigit(c) || c == '-' || c == '+' || (real && c == '.')) {
+                return true;
+            }
+            ++pos;
+        }
+        return false;
+    }
+
+    //Converts the run of digits at pos into 'value'. Returns false if it does not fit in 64 bits.
+    bool parseDigits(uint64_t& value) {
+        value = 0;
+        while (stop - pos >= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, pos, 8);
+            // Eight ASCII digits have 0x3 in every high nibble and no byte above '9'
+            uint64_t low = chunk - 0x3030303030303030ULL;
+            uint64_t tooBig = (chunk + 0x4646464646464646ULL) | low;
+            if ((tooBig & 0x8080808080808080ULL) != 0 || (chunk & 0xF0F0F0F0F0F0F0F0ULL) != 0x3030303030303030ULL) break;
+            // Combine pairs, then quadruples, then the two halves (little-endian byte order)
+            low = (low * 10) + (low >> 8);
+            low = (((low & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+                   (((low >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+            if (__builtin_mul_overflow(value, 100000000ULL, &value) || __builtin_add_overflow(value, low, &value)) return false;
+            pos += 8;
+        }
+        while (pos < stop && isDigit(*pos)) {
+            if (__builtin_mul_overflow(value, 10ULL, &value) || __builtin_add_overflow(value, (uint64_t)(*pos - '0'), &value)) {
+                return false;
+            }
+            ++pos;
+        }
+        return true;
+    }
+
+    const char* first;
+    const char* pos;
+    const char* stop;
+    int openedSince = 0;
+    int closedSince = 0;
+    int nesting = 0;
+    const char* overflowAt = nullptr;
+};
+
+//Message for a scanner that stopped at a number out of range
+inline std::string numberOverflowError(const IntegerScanner& scanner) {
+    return "the number at byte " + std::to_string(scanner.overflowOffset()) + " is out of range";
+}
+
+// --- Binary Format ---
+
+const char BINARY_MAGIC[8] = {'A', 'L', 'G', 'O', 'B', 'I', 'N', '1'};
+
+enum BinaryElementType : uint32_t {
+    BINARY_INT32 = 1,
+    BINARY_INT64 = 2,
+    BINARY_FLOAT32 = 3,
+    BINARY_FLOAT64 = 4
+};
+
+//Binary element type code of T
+template <typename T>
+constexpr uint32_t binaryElementType() {
+    if constexpr (std::is_same<T, int32_t>::value) return BINARY_INT32;
+    else if constexpr (std::is_same<T, int64_t>::value) return BINARY_INT64;
+    else if constexpr (std::is_same<T, float>::value) return BINARY_FLOAT32;
+    else {
+        static_assert(std::is_same<T, double>::value, "No binary encoding for this element type");
+        return BINARY_FLOAT64;
+    }
+}
+
+inline size_t binaryElementSize(uint32_t type) {
+    return (type == BINARY_INT32 || type == BINARY_FLOAT32) ? 4 : 8;
+}
+
+/**
+ * @brief A binary array viewed in place inside a mapped file.
+ */
+struct BinaryArray {
+    uint32_t elementType = BINARY_INT32;
+    std::vector<uint64_t> dims;
+    const char* data = nullptr;
+    size_t count = 0;
+
+    //Element i converted to T
+    template <typename T>
+    T get(size_t i) const {
+        const char* source = data + i * binaryElementSize(elementType);
+        switch (elementType) {
+        case BINARY_INT32: { int32_t v; std::memcpy(&v, source, 4); return T(v); }
+        case BINARY_INT64: { int64_t v; std::memcpy(&v, source, 8); return T(v); }
+        case BINARY_FLOAT32: { float v; std::memcpy(&v, source, 4); return T(v); }
+        default: { double v; std::memcpy(&v, source, 8); return T(v); }
+        }
+    }
+};
+
+inline bool hasBinaryMagic(const char* data, size_t size) {
+    return size >= sizeof(BINARY_MAGIC) && std::memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0;
+}
+
+//Validates the header of a binary file. Returns false and explains why in 'error' if it is malformed.
+inline bool parseBinaryArray(const char* data, size_t size, BinaryArray& array, std::string& error) {
+    const size_t fixed = sizeof(BINARY_MAGIC) + 2 * sizeof(uint32_t);
+    if (!hasBinaryMagic(data, size) || size < fixed) {
+        error = "not a binary array file";
+        return false;
+    }
+    uint32_t rank;
+    std::memcpy(&array.elementType, data + 8, 4);
+    std::memcpy(&rank, data + 12, 4);
+    if (array.elementType < BINARY_INT32 || array.elementType > BINARY_FLOAT64 || rank == 0 || rank > 4) {
+        error = "binary header has an unknown element type or rank";
+        return false;
+    }
+    size_t header = fixed + rank * sizeof(uint64_t);
+    if (size < header) {
+        error = "binary header is truncated";
+        return false;
+    }
+    array.dims.resize(rank);
+    std::memcpy(array.dims.data(), data + fixed, rank * sizeof(uint64_t));
+    //Every dimension must fit in what is left of the file, checked before multiplying so the count cannot wrap
+    const size_t elements = (size - header) / binaryElementSize(array.elementType);
+    array.count = 1;
+    for (uint64_t d : array.dims) {
+        if (d == 0 || d > elements / array.count) {
+            error = d == 0 ? "binary header has an empty dimension" : "binary file is shorter than its header says";
+            return false;
+        }
+        array.count *= (size_t)d;
+    }
+    array.data = data + header;
+    return true;
+}
+
+//Writes 'values' (the product of 'dims' elements, row-major) as a binary array file
+template <typename T>
+bool writeBinaryArray(const std::string& filename, const std::vector<uint64_t>& dims, const T* values) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+    uint32_t type = binaryElementType<T>(), rank = (uint32_t)dims.size();
+    size_t count = 1;
+    for (uint64_t d : dims) count *= (size_t)d;
+    file.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    file.write((const char*)&type, sizeof(type));
+    file.write((const char*)&rank, sizeof(rank));
+    file.write((const char*)dims.data(), dims.size() * sizeof(uint64_t));
+    file.write((const char*)values, count * sizeof(T));
+    return (bool)file;
+}
+
+// --- Whole-File Helpers ---
+
+/**
+ * @brief Reads every integer of a text or binary file in order, ignoring the brace structure.
+ * This is the whole input format of the solvers that take a flat list of numbers.
+ * Returns false and explains why in 'error' if the file is missing or malformed.
+ */
+inline bool readIntegerList(const std::string& filename, std::vector<int64_t>& values, std::string& error) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        error = "Could not open file " + filename;
+        return false;
+    }
+    values.clear();
+    if (hasBinaryMagic(file.data(), file.size())) {
+        BinaryArray array;
+        if (!parseBinaryArray(file.data(), file.size(), array, error)) {
+            error = filename + ": " + error;
+            return false;
+        }
+        values.reserve(array.count);
+        for (size_t i = 0; i < array.count; ++i) values.push_back(array.get<int64_t>(i));
+        return true;
+    }
+    IntegerScanner scanner(file.data(), file.end());
+    int64_t value;
+    while (scanner.next(value)) values.push_back(value);
+    if (scanner.overflowed()) {
+        error = filename + ": " + numberOverflowError(scanner) + " (numbers must fit in 64 bits)";
+        return false;
+    }
+    return true;
+}
+
+//Writes the integers of a text file as a rank-1 binary array (int32 when every value fits, int64 otherwise)
+inline bool convertIntegerListToBinary(const std::string& input, const std::string& output, std::string& error) {
+    std::vector<int64_t> values;
+    if (!readIntegerList(input, values, error)) return false;
+    bool narrow = true;
+    for (int64_t v : values) narrow = narrow && v == (int64_t)(int32_t)v;
+    bool written;
+    if (narrow) {
+        std::vector<int32_t> compact(values.begin(), values.end());
+        written = writeBinaryArray(output, {(uint64_t)compact.size()}, compact.data());
+    } else {
+        written = writeBinaryArray(output, {(uint64_t)values.size()}, values.data());
+    }
+    if (!written) error = "Could not write " + output;
+    return written;
+}
+
+// --- Command-Line Numbers ---
+
+//Parses the whole of 'text' as an int or a finite double. Returns false, leaving 'value' alone,
+//for anything else: an empty string, trailing characters ("12abc") or a value out of range.
+template <typename T>
+bool parseNumber(const std::string& text, T& value) {
+    static_assert(std::is_same<T, int>::value || std::is_same<T, double>::value, "Numbers are int or double");
+    T parsed{};
+    const char* end = text.data() + text.size();
+    std::from_chars_result result = std::from_chars(text.data(), end, parsed);
+    if (result.ec != std::errc() || result.ptr != end || text.empty()) return false;
+    if constexpr (std::is_same<T, double>::value) {
+        if (!std::isfinite(parsed)) return false;
+    }
+    value = parsed;
+    return true;
+}
+
+//Reports a flag value that parseNumber (or a range check) rejected; returns the exit code for main
+inline int badFlagValue(const std::string& flag, const std::string& text, const std::string& expected = "a number") {
+    std::cerr << "Error: " << flag << " expects " << expected << ", got '" << text << "'." << std::endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,190 @@
+/**
+ * Work-stealing thread pool shared by the algorithms in this repository.
+ *
+ * Every worker owns a deque of tasks. A worker pushes and pops its own tasks at the back
+ * (newest first, so the data it just touched is still in cache) and, when it runs dry,
+ * steals from the front of another worker's deque (oldest first, which for divide and
+ * conquer work are the largest pieces). Threads that are not part of the pool hand their
+ * tasks out round-robin.
+ *
+ * Tasks are grouped with TaskGroup. TaskGroup::wait() keeps running queued tasks while it
+ * waits, so a task may itself spawn a group and wait on it without tying up a worker.
+*/
+
+#ifndef COMMON_THREAD_POOL_H
+#define COMMON_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    //Starts 'threads' workers; 0 uses one per hardware thread
+    explicit ThreadPool(unsigned threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; ++i) {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return (unsigned)workers.size(); }
+
+    //Queues a task. Workers push onto their own deque, other threads spread tasks round-robin.
+    void submit(std::function<void()> task) {
+        size_t target = (currentPool == this) ? currentWorker : nextQueue++ % queues.size();
+        pending.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(queues[target]->mutex);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        {
+            // Taking the lock orders this wake-up after any worker that is about to sleep
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_one();
+    }
+
+    //Runs one queued task on the calling thread if any is available. Returns false when every queue is empty.
+    bool runPendingTask() {
+        std::function<void()> task;
+        size_t home = (currentPool == this) ? currentWorker : 0;
+        if (!takeTask(home, task)) return false;
+        task();
+        return true;
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    //Pops from the back of our own deque, then tries to steal from the front of the others
+    bool takeTask(size_t home, std::function<void()>& task) {
+        for (size_t attempt = 0; attempt < queues.size(); ++attempt) {
+            size_t index = (home + attempt) % queues.size();
+            WorkQueue& queue = *queues[index];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+            if (attempt == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            pending.fetch_sub(1);
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(size_t index) {
+        currentPool = this;
+        currentWorker = index;
+        std::function<void()> task;
+        while (true) {
+            if (takeTask(index, task)) {
+                task();
+                task = nullptr;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return stopping || pending > 0; });
+            if (stopping && pending == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextQueue{0};
+
+    // 'pending' counts queued (not yet started) tasks; idle workers sleep on 'wake' until it is non-zero
+    std::atomic<size_t> pending{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // Identifies the pool and queue of the worker running on this thread, if any
+    static inline thread_local ThreadPool* currentPool = nullptr;
+    static inline thread_local size_t currentWorker = 0;
+};
+
+//Pool for a call that runs on 'threads' threads in total. The calling thread helps while it waits
+//on its TaskGroups, so the pool gets one thread fewer; with a single thread there is no pool at all.
+inline std::unique_ptr<ThreadPool> helperPool(unsigned threads) {
+    if (threads <= 1) return nullptr;
+    return std::make_unique<ThreadPool>(threads - 1);
+}
+
+/**
+ * @brief A set of tasks that can be waited on together. The first exception thrown by any
+ * task is re-thrown from wait().
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+
+    //Waiting here keeps a group from being destroyed while its tasks still reference it
+    ~TaskGroup() {
+        while (remaining.load() > 0) {
+            if (!pool.runPendingTask()) std::this_thread::yield();
+        }
+    }
+
+    void run(std::function<void()> task) {
+        remaining.fetch_add(1);
+        pool.submit([this, task = std::move(task)] {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+            }
+            remaining.fetch_sub(1);
+        });
+    }
+
+    //Helps run queued tasks until every task of this group has finished
+    void wait() {
+        while (remaining.load() > 0) {
+            if (!pool.runPendingTask()) std::this_thread::yield();
+        }
+        if (error) {
+            std::exception_ptr thrown = error;
+            error = nullptr;
+            std::rethrow_exception(thrown);
+        }
+    }
+
+private:
+    ThreadPool& pool;
+    std::atomic<int> remaining{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+#endif
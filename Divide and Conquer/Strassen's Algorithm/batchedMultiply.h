@@ -0,0 +1,170 @@
+/**
+ * Batched multiplication of many small, independent square matrices.
+ *
+ * For an 8x8 or 32x32 product the Strassen entry point costs far more than the arithmetic:
+ * it allocates C and a workspace, checks cutoffs and packs panels that are used once. The
+ * batched API takes all pairs in one contiguous array and multiplies them with kernels that
+ * know n at compile time (8, 16 and 32), so every loop bound is a constant, a row of C lives
+ * in registers and the compiler unrolls and vectorizes the whole product. Other sizes,
+ * 64 included, go straight to the blocked kernel with no Strassen entry overhead. Batches
+ * are split into chunks across a pool.
+*/
+
+#ifndef STRASSEN_BATCHED_MULTIPLY_H
+#define STRASSEN_BATCHED_MULTIPLY_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "../../Common/cpuFeatures.h"
+#include "../../Common/threadPool.h"
+#include "gemmKernels.h"
+#include "matrix.h"
+#include "productReductions.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SMALL_KERNEL_INLINE inline __attribute__((always_inline))
+#else
+#define SMALL_KERNEL_INLINE inline
+#endif
+
+// --- Fixed-Size Kernels ---
+
+template <typename T>
+struct IsModInt : std::false_type {};
+
+template <uint32_t P>
+struct IsModInt<ModInt<P>> : std::true_type {};
+
+/**
+ * @brief C = A * B for N x N row-major matrices, with N fixed at compile time. One row of C is
+ * accumulated at a time in i-p-j order. Integers accumulate in uint64_t (wrapping exactly like
+ * the engine), ModInt residues accumulate in uint64_t and are reduced every modularBatch<P>()
+ * products, floating-point types accumulate in their own type.
+ */
+template <int N, typename T>
+SMALL_KERNEL_INLINE void smallKernelBody(const T* __restrict a, const T* __restrict b, ResultType<T>* __restrict c) {
+    using R = ResultType<T>;
+    if constexpr (IsModInt<T>::value) {
+        constexpr uint32_t P = T::MODULUS;
+        constexpr int batch = modularBatch<P>();
+        for (int i = 0; i < N; ++i) {
+            uint64_t acc[N] = {};
+            for (int p = 0; p < N; ++p) {
+                uint64_t x = a[i * N + p].value;
+                const T* row = b + p * N;
+                for (int j = 0; j < N; ++j) acc[j] += x * row[j].value;
+                if ((p + 1) % batch == 0) {
+                    for (int j = 0; j < N; ++j) acc[j] %= P;
+                }
+            }
+            for (int j = 0; j < N; ++j) c[i * N + j] = R::fromReduced((uint32_t)(acc[j] % P));
+        }
+    } else if constexpr (std::is_integral<T>::value) {
+        for (int i = 0; i < N; ++i) {
+            uint64_t acc[N] = {};
+            for (int p = 0; p < N; ++p) {
+                int64_t x = a[i * N + p];
+                const T* row = b + p * N;
+                if constexpr (sizeof(T) == 4) {
+                    // A 32 x 32 -> 64 bit product is exact, so the compiler can use a widening multiply
+                    for (int j = 0; j < N; ++j) acc[j] += (uint64_t)(x * (int64_t)row[j]);
+                } else {
+                    for (int j = 0; j < N; ++j) acc[j] += (uint64_t)x * (uint64_t)row[j];
+                }
+            }
+            for (int j = 0; j < N; ++j) c[i * N + j] = (R)acc[j];
+        }
+    } else {
+        for (int i = 0; i < N; ++i) {
+            R acc[N] = {};
+            for (int p = 0; p < N; ++p) {
+                R x = a[i * N + p];
+                const T* row = b + p * N;
+                for (int j = 0; j < N; ++j) acc[j] += x * row[j];
+            }
+            for (int j = 0; j < N; ++j) c[i * N + j] = acc[j];
+        }
+    }
+}
+
+template <typename T>
+using SmallKernel = void (*)(const T*, const T*, ResultType<T>*);
+
+//Specialised kernel for n x n products, or nullptr if n has none. From 64 on, packing into the
+//blocked kernel's register tiles already pays for itself and beats the unpacked fixed-size loops.
+template <typename T>
+SmallKernel<T> selectSmallKernel(int n) {
+    switch (n) {
+    case 8: return SimdKernel<smallKernelBody<8, T>>::select();
+    case 16: return SimdKernel<smallKernelBody<16, T>>::select();
+    case 32: return SimdKernel<smallKernelBody<32, T>>::select();
+    default: return nullptr;
+    }
+}
+
+// --- Batched API ---
+
+//Multiplies pairs [first, last) of a batch on the calling thread
+template <typename T>
+void multiplyBatchRange(const T* pairs, ResultType<T>* products, int n, size_t first, size_t last) {
+    using R = ResultType<T>;
+    const size_t size = (size_t)n * n;
+    SmallKernel<T> kernel = selectSmallKernel<T>(n);
+    std::vector<R> widenedA, widenedB;
+    for (size_t i = first; i < last; ++i) {
+        const T* a = pairs + 2 * i * size;
+        const T* b = a + size;
+        R* c = products + i * size;
+        if (kernel != nullptr) {
+            kernel(a, b, c);
+            continue;
+        }
+        // No specialised kernel for this size: the blocked kernel still avoids the Strassen entry overhead
+        ConstMatrixView<T> viewA(a, n, n, n), viewB(b, n, n, n);
+        MatrixView<R> viewC{c, n, n, n};
+        if constexpr (std::is_same<T, R>::value) {
+            blockedMultiply<R>(viewA, viewB, viewC);
+        } else {
+            blockedMultiply<R>(copyAsResultType<R>(viewA, widenedA), copyAsResultType<R>(viewB, widenedB), viewC);
+        }
+    }
+}
+
+/**
+ * @brief Multiplies 'count' independent pairs of n x n matrices. 'pairs' holds them back to back,
+ * A_0, B_0, A_1, B_1, ..., each n * n entries in row-major order, and products + i * n * n
+ * receives A_i * B_i (int32 inputs give exact int64 products, as everywhere in the engine).
+ * The batch is split into chunks that run on 'pool' and on the calling thread.
+ */
+template <typename T>
+void batchedMultiply(const T* pairs, ResultType<T>* products, int n, size_t count, ThreadPool &pool) {
+    // A few chunks per thread balance the load without making chunks so small that scheduling shows
+    size_t chunks = std::min(count, (size_t)(pool.size() + 1) * 4);
+    if (chunks <= 1) {
+        multiplyBatchRange(pairs, products, n, 0, count);
+        return;
+    }
+    TaskGroup group(pool);
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        size_t first = count * chunk / chunks, last = count * (chunk + 1) / chunks;
+        group.run([=] { multiplyBatchRange(pairs, products, n, first, last); });
+    }
+    group.wait();
+}
+
+//Same, on 'threads' threads in total (1 keeps the whole batch on the calling thread)
+template <typename T>
+void batchedMultiply(const T* pairs, ResultType<T>* products, int n, size_t count, unsigned threads = 1) {
+    if (threads <= 1) {
+        multiplyBatchRange(pairs, products, n, 0, count);
+        return;
+    }
+    std::unique_ptr<ThreadPool> pool = helperPool(threads);
+    batchedMultiply(pairs, products, n, count, *pool);
+}
+
+#endif
@@ -0,0 +1,548 @@
+/**
+ * Packed, register-blocked base-case kernels for the Strassen engine, one family per element type.
+ *
+ * The kernel follows the usual blocked GEMM structure: a KC-deep slab of B is packed into
+ * NR-wide column strips and an MC x KC block of A into MR-tall row strips, so the innermost
+ * micro-kernel streams both operands from contiguous memory and keeps an MR x NR tile of C
+ * in registers for the whole slab.
+ *
+ * Which micro-kernels exist is decided at compile time by the element type (GemmKernelFactory
+ * is specialised per type); which instruction set they use is picked once at runtime:
+ *   int64_t   - AVX-512: 32 x 32 -> 64 bit multiplies (vpmuldq) while the packed values fit in
+ *               32 bits, full 64-bit multiplies (vpmullq) otherwise; AVX2: vpmuldq for narrow
+ *               values, the scalar kernel for wide ones
+ *   float     - AVX-512 / AVX2 fused multiply-add
+ *   double    - AVX-512 / AVX2 fused multiply-add
+ *   ModInt<P> - 64-bit accumulation with the modulo taken once per batch of products instead of
+ *               after every one (AVX-512 or scalar)
+*/
+
+#ifndef STRASSEN_GEMM_KERNELS_H
+#define STRASSEN_GEMM_KERNELS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "../../Common/cpuFeatures.h"
+#include "matrix.h"
+
+const int GEMM_KC = 256; // Depth of one packed slab
+const int GEMM_MC = 96;  // Rows of A packed at a time (a multiple of every MR below)
+const int GEMM_NC = 2048; // Columns of B packed at a time
+const int GEMM_MAX_TILE = 6 * 32; // Largest MR x NR of any kernel
+
+// --- Packing ---
+
+//True for values a 32 x 32 -> 64 bit multiply handles exactly
+inline bool fitsIn32Bits(int64_t value) {
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+//Packs rows [row, row + mc) x columns [depth, depth + kc) of A into MR-tall strips, zero-filling the last strip
+//Returns whether every packed value fits in 32 bits (only tracked for int64_t; always false otherwise)
+template <int MR, typename T>
+bool packStripsA(ConstMatrixView<T> A, int row, int mc, int depth, int kc, T* packed) {
+    bool narrow = std::is_same<T, int64_t>::value;
+    for (int strip = 0; strip < mc; strip += MR) {
+        for (int p = 0; p < kc; ++p) {
+            for (int r = 0; r < MR; ++r) {
+                T value = (strip + r < mc) ? A[row + strip + r][depth + p] : T();
+                if constexpr (std::is_same<T, int64_t>::value) narrow = narrow && fitsIn32Bits(value);
+                *packed++ = value;
+            }
+        }
+    }
+    return narrow;
+}
+
+//Packs rows [depth, depth + kc) x columns [col, col + nc) of B into NR-wide strips, zero-filling the last strip
+template <int NR, typename T>
+bool packStripsB(ConstMatrixView<T> B, int depth, int kc, int col, int nc, T* packed) {
+    bool narrow = std::is_same<T, int64_t>::value;
+    for (int strip = 0; strip < nc; strip += NR) {
+        int width = std::min(NR, nc - strip);
+        for (int p = 0; p < kc; ++p) {
+            const T* source = B[depth + p] + col + strip;
+            for (int c = 0; c < width; ++c) {
+                if constexpr (std::is_same<T, int64_t>::value) narrow = narrow && fitsIn32Bits(source[c]);
+                packed[c] = source[c];
+            }
+            for (int c = width; c < NR; ++c) packed[c] = T();
+            packed += NR;
+        }
+    }
+    return narrow;
+}
+
+// --- Portable Micro-Kernels ---
+
+//Portable micro-kernel: c (an MR x NR tile with row stride ldc) = or += packed A strip * packed B strip
+template <int MR, int NR, typename T>
+void microKernelScalar(int kc, const T* a, const T* b, T* c, int ldc, bool accumulate) {
+    // Integers are accumulated unsigned, which wraps exactly like the SIMD kernels without overflow UB
+    using Acc = typename std::conditional<std::is_integral<T>::value, std::make_unsigned<T>, std::common_type<T>>::type::type;
+    Acc acc[MR][NR] = {};
+    for (int p = 0; p < kc; ++p) {
+        for (int r = 0; r < MR; ++r) {
+            Acc av = (Acc)a[p * MR + r];
+            for (int col = 0; col < NR; ++col) {
+                acc[r][col] += av * (Acc)b[p * NR + col];
+            }
+        }
+    }
+    for (int r = 0; r < MR; ++r) {
+        for (int col = 0; col < NR; ++col) {
+            Acc base = accumulate ? (Acc)c[r * ldc + col] : Acc();
+            c[r * ldc + col] = (T)(base + acc[r][col]);
+        }
+    }
+}
+
+//Products of two residues that can be summed in 64 bits before a reduction is due
+template <uint32_t P>
+constexpr int modularBatch() {
+    uint64_t square = (uint64_t)(P - 1) * (P - 1);
+    return (int)std::min<uint64_t>((UINT64_MAX - P) / square, GEMM_KC);
+}
+
+//Micro-kernel for ModInt<P>: exact 64-bit sums of up to modularBatch<P>() products, reduced between batches
+template <int MR, int NR, uint32_t P>
+void microKernelModScalar(int kc, const ModInt<P>* a, const ModInt<P>* b, ModInt<P>* c, int ldc, bool accumulate) {
+    const int batch = modularBatch<P>();
+    uint64_t acc[MR][NR] = {};
+    for (int start = 0; start < kc; start += batch) {
+        int end = std::min(kc, start + batch);
+        for (int p = start; p < end; ++p) {
+            for (int r = 0; r < MR; ++r) {
+                uint64_t av = a[p * MR + r].value;
+                for (int col = 0; col < NR; ++col) {
+                    acc[r][col] += av * b[p * NR + col].value;
+                }
+            }
+        }
+        for (int r = 0; r < MR; ++r) {
+            for (int col = 0; col < NR; ++col) acc[r][col] %= P;
+        }
+    }
+    for (int r = 0; r < MR; ++r) {
+        for (int col = 0; col < NR; ++col) {
+            ModInt<P> sum = ModInt<P>::fromReduced((uint32_t)acc[r][col]);
+            c[r * ldc + col] = accumulate ? c[r * ldc + col] + sum : sum;
+        }
+    }
+}
+
+// --- SIMD Micro-Kernels ---
+
+#ifdef ALGORITHMS_X86_SIMD
+// GCC 12's avx512fintrin.h builds _mm512_mul_epi32, _mm512_mul_epu32 and _mm512_cvtepu32_epi64
+// from an undefined vector and reports it as maybe uninitialized; the warning is a false positive
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+//int64 AVX-512, narrow values: a 6 x 16 tile of C in twelve zmm registers, vpmuldq multiplies
+ALGORITHMS_TARGET("avx512f")
+void microKernelInt64NarrowAvx512(int kc, const int64_t* a, const int64_t* b, int64_t* c, int ldc, bool accumulate) {
+    const int MR = 6;
+    __m512i acc[MR][2];
+    for (int r = 0; r < MR; ++r) acc[r][0] = acc[r][1] = _mm512_setzero_si512();
+
+    for (int p = 0; p < kc; ++p) {
+        __m512i b0 = _mm512_loadu_si512(b + p * 16);
+        __m512i b1 = _mm512_loadu_si512(b + p * 16 + 8);
+#pragma GCC unroll 6
+        for (int r = 0; r < MR; ++r) {
+            __m512i av = _mm512_set1_epi64(a[p * MR + r]);
+            acc[r][0] = _mm512_add_epi64(acc[r][0], _mm512_mul_epi32(av, b0));
+            acc[r][1] = _mm512_add_epi64(acc[r][1], _mm512_mul_epi32(av, b1));
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        int64_t* row = c + r * ldc;
+        if (accumulate) {
+            acc[r][0] = _mm512_add_epi64(acc[r][0], _mm512_loadu_si512(row));
+            acc[r][1] = _mm512_add_epi64(acc[r][1], _mm512_loadu_si512(row + 8));
+        }
+        _mm512_storeu_si512(row, acc[r][0]);
+        _mm512_storeu_si512(row + 8, acc[r][1]);
+    }
+}
+#pragma GCC diagnostic pop
+
+//int64 AVX-512, any values: same tile with full 64-bit multiplies (vpmullq, AVX-512 DQ)
+ALGORITHMS_TARGET("avx512f,avx512dq")
+void microKernelInt64Avx512(int kc, const int64_t* a, const int64_t* b, int64_t* c, int ldc, bool accumulate) {
+    const int MR = 6;
+    __m512i acc[MR][2];
+    for (int r = 0; r < MR; ++r) acc[r][0] = acc[r][1] = _mm512_setzero_si512();
+
+    for (int p = 0; p < kc; ++p) {
+        __m512i b0 = _mm512_loadu_si512(b + p * 16);
+        __m512i b1 = _mm512_loadu_si512(b + p * 16 + 8);
+#pragma GCC unroll 6
+        for (int r = 0; r < MR; ++r) {
+            __m512i av = _mm512_set1_epi64(a[p * MR + r]);
+            acc[r][0] = _mm512_add_epi64(acc[r][0], _mm512_mullo_epi64(av, b0));
+            acc[r][1] = _mm512_add_epi64(acc[r][1], _mm512_mullo_epi64(av, b1));
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        int64_t* row = c + r * ldc;
+        if (accumulate) {
+            acc[r][0] = _mm512_add_epi64(acc[r][0], _mm512_loadu_si512(row));
+            acc[r][1] = _mm512_add_epi64(acc[r][1], _mm512_loadu_si512(row + 8));
+        }
+        _mm512_storeu_si512(row, acc[r][0]);
+        _mm512_storeu_si512(row + 8, acc[r][1]);
+    }
+}
+
+//int64 AVX2, narrow values: a 6 x 8 tile of C in twelve ymm registers, vpmuldq multiplies
+ALGORITHMS_TARGET("avx2")
+void microKernelInt64NarrowAvx2(int kc, const int64_t* a, const int64_t* b, int64_t* c, int ldc, bool accumulate) {
+    const int MR = 6;
+    __m256i acc[MR][2];
+    for (int r = 0; r < MR; ++r) acc[r][0] = acc[r][1] = _mm256_setzero_si256();
+
+    for (int p = 0; p < kc; ++p) {
+        __m256i b0 = _mm256_loadu_si256((const __m256i*)(b + p * 8));
+        __m256i b1 = _mm256_loadu_si256((const __m256i*)(b + p * 8 + 4));
+#pragma GCC unroll 6
+        for (int r = 0; r < MR; ++r) {
+            __m256i av = _mm256_set1_epi64x(a[p * MR + r]);
+            acc[r][0] = _mm256_add_epi64(acc[r][0], _mm256_mul_epi32(av, b0));
+            acc[r][1] = _mm256_add_epi64(acc[r][1], _mm256_mul_epi32(av, b1));
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        __m256i* row = (__m256i*)(c + r * ldc);
+        if (accumulate) {
+            acc[r][0] = _mm256_add_epi64(acc[r][0], _mm256_loadu_si256(row));
+            acc[r][1] = _mm256_add_epi64(acc[r][1], _mm256_loadu_si256(row + 1));
+        }
+        _mm256_storeu_si256(row, acc[r][0]);
+        _mm256_storeu_si256(row + 1, acc[r][1]);
+    }
+}
+
+//float AVX-512: a 6 x 32 tile of C in twelve zmm registers
+ALGORITHMS_TARGET("avx512f")
+void microKernelFloatAvx512(int kc, const float* a, const float* b, float* c, int ldc, bool accumulate) {
+    const int MR = 6;
+    __m512 acc[MR][2];
+    for (int r = 0; r < MR; ++r) acc[r][0] = acc[r][1] = _mm512_setzero_ps();
+
+    for (int p = 0; p < kc; ++p) {
+        __m512 b0 = _mm512_loadu_ps(b + p * 32);
+        __m512 b1 = _mm512_loadu_ps(b + p * 32 + 16);
+#pragma GCC unroll 6
+        for (int r = 0; r < MR; ++r) {
+            __m512 av = _mm512_set1_ps(a[p * MR + r]);
+            acc[r][0] = _mm512_fmadd_ps(av, b0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_ps(av, b1, acc[r][1]);
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        float* row = c + r * ldc;
+        if (accumulate) {
+            acc[r][0] = _mm512_add_ps(acc[r][0], _mm512_loadu_ps(row));
+            acc[r][1] = _mm512_add_ps(acc[r][1], _mm512_loadu_ps(row + 16));
+        }
+        _mm512_storeu_ps(row, acc[r][0]);
+        _mm512_storeu_ps(row + 16, acc[r][1]);
+    }
+}
+
+//float AVX2: a 6 x 16 tile of C in twelve ymm registers
+ALGORITHMS_TARGET("avx2,fma")
+void microKernelFloatAvx2(int kc, const float* a, const float* b, float* c, int ldc, bool accumulate) {
+    const int MR = 6;
+    __m256 acc[MR][2];
+    for (int r = 0; r < MR; ++r) acc[r][0] = acc[r][1] = _mm256_setzero_ps();
+
+    for (int p = 0; p < kc; ++p) {
+        __m256 b0 = _mm256_loadu_ps(b + p * 16);
+        __m256 b1 = _mm256_loadu_ps(b + p * 16 + 8);
+#pragma GCC unroll 6
+        for (int r = 0; r < MR; ++r) {
+            __m256 av = _mm256_set1_ps(a[p * MR + r]);
+            acc[r][0] = _mm256_fmadd_ps(av, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(av, b1, acc[r][1]);
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        float* row = c + r * ldc;
+        if (accumulate) {
+            acc[r][0] = _mm256_add_ps(acc[r][0], _mm256_loadu_ps(row));
+            acc[r][1] = _mm256_add_ps(acc[r][1], _mm256_loadu_ps(row + 8));
+        }
+        _mm256_storeu_ps(row, acc[r][0]);
+        _mm256_storeu_ps(row + 8, acc[r][1]);
+    }
+}
+
+//double AVX-512: a 6 x 16 tile of C in twelve zmm registers
+ALGORITHMS_TARGET("avx512f")
+void microKernelDoubleAvx512(int kc, const double* a, const double* b, double* c, int ldc, bool accumulate) {
+    const int MR = 6;
+    __m512d acc[MR][2];
+    for (int r = 0; r < MR; ++r) acc[r][0] = acc[r][1] = _mm512_setzero_pd();
+
+    for (int p = 0; p < kc; ++p) {
+        __m512d b0 = _mm512_loadu_pd(b + p * 16);
+        __m512d b1 = _mm512_loadu_pd(b + p * 16 + 8);
+#pragma GCC unroll 6
+        for (int r = 0; r < MR; ++r) {
+            __m512d av = _mm512_set1_pd(a[p * MR + r]);
+            acc[r][0] = _mm512_fmadd_pd(av, b0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_pd(av, b1, acc[r][1]);
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        double* row = c + r * ldc;
+        if (accumulate) {
+            acc[r][0] = _mm512_add_pd(acc[r][0], _mm512_loadu_pd(row));
+            acc[r][1] = _mm512_add_pd(acc[r][1], _mm512_loadu_pd(row + 8));
+        }
+        _mm512_storeu_pd(row, acc[r][0]);
+        _mm512_storeu_pd(row + 8, acc[r][1]);
+    }
+}
+
+//double AVX2: a 6 x 8 tile of C in twelve ymm registers
+ALGORITHMS_TARGET("avx2,fma")
+void microKernelDoubleAvx2(int kc, const double* a, const double* b, double* c, int ldc, bool accumulate) {
+    const int MR = 6;
+    __m256d acc[MR][2];
+    for (int r = 0; r < MR; ++r) acc[r][0] = acc[r][1] = _mm256_setzero_pd();
+
+    for (int p = 0; p < kc; ++p) {
+        __m256d b0 = _mm256_loadu_pd(b + p * 8);
+        __m256d b1 = _mm256_loadu_pd(b + p * 8 + 4);
+#pragma GCC unroll 6
+        for (int r = 0; r < MR; ++r) {
+            __m256d av = _mm256_set1_pd(a[p * MR + r]);
+            acc[r][0] = _mm256_fmadd_pd(av, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_pd(av, b1, acc[r][1]);
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        double* row = c + r * ldc;
+        if (accumulate) {
+            acc[r][0] = _mm256_add_pd(acc[r][0], _mm256_loadu_pd(row));
+            acc[r][1] = _mm256_add_pd(acc[r][1], _mm256_loadu_pd(row + 4));
+        }
+        _mm256_storeu_pd(row, acc[r][0]);
+        _mm256_storeu_pd(row + 4, acc[r][1]);
+    }
+}
+
+// The same false positive as in microKernelInt64NarrowAvx512
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+//ModInt<P> AVX-512: a 6 x 16 tile of 64-bit sums (vpmuludq products), reduced modulo P between batches
+template <uint32_t P>
+ALGORITHMS_TARGET("avx512f")
+void microKernelModAvx512(int kc, const ModInt<P>* a, const ModInt<P>* b, ModInt<P>* c, int ldc, bool accumulate) {
+    const int MR = 6, NR = 16;
+    const int batch = modularBatch<P>();
+    // ModInt<P> is a single uint32_t, so a packed strip is a plain array of residues
+    const uint32_t* as = (const uint32_t*)a;
+    const uint32_t* bs = (const uint32_t*)b;
+
+    __m512i acc[MR][2];
+    for (int r = 0; r < MR; ++r) acc[r][0] = acc[r][1] = _mm512_setzero_si512();
+    alignas(64) uint64_t sums[MR][NR];
+
+    for (int start = 0; start < kc; start += batch) {
+        int end = std::min(kc, start + batch);
+        for (int p = start; p < end; ++p) {
+            __m512i b0 = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i*)(bs + p * NR)));
+            __m512i b1 = _mm512_cvtepu32_epi64(_mm256_loadu_si256((const __m256i*)(bs + p * NR + 8)));
+#pragma GCC unroll 6
+            for (int r = 0; r < MR; ++r) {
+                __m512i av = _mm512_set1_epi64(as[p * MR + r]);
+                acc[r][0] = _mm512_add_epi64(acc[r][0], _mm512_mul_epu32(av, b0));
+                acc[r][1] = _mm512_add_epi64(acc[r][1], _mm512_mul_epu32(av, b1));
+            }
+        }
+        // There is no vector remainder, so the reduction goes through memory
+        for (int r = 0; r < MR; ++r) {
+            _mm512_store_si512(sums[r], acc[r][0]);
+            _mm512_store_si512(sums[r] + 8, acc[r][1]);
+            for (int col = 0; col < NR; ++col) sums[r][col] %= P;
+            acc[r][0] = _mm512_load_si512(sums[r]);
+            acc[r][1] = _mm512_load_si512(sums[r] + 8);
+        }
+    }
+
+    for (int r = 0; r < MR; ++r) {
+        for (int col = 0; col < NR; ++col) {
+            ModInt<P> sum = ModInt<P>::fromReduced((uint32_t)sums[r][col]);
+            c[r * ldc + col] = accumulate ? c[r * ldc + col] + sum : sum;
+        }
+    }
+}
+#pragma GCC diagnostic pop
+#endif
+
+// --- Kernel Selection ---
+
+/**
+ * @brief A micro-kernel together with its register block shape and matching packing routines.
+ * 'microNarrow' is used instead of 'micro' when both packed operands fit in 32 bits; kernels
+ * without a cheaper narrow path use the same function for both.
+ */
+template <typename T>
+struct GemmKernel {
+    using Micro = void (*)(int kc, const T* a, const T* b, T* c, int ldc, bool accumulate);
+
+    const char* name;
+    int mr;
+    int nr;
+    Micro micro;
+    Micro microNarrow;
+    bool (*packA)(ConstMatrixView<T> A, int row, int mc, int depth, int kc, T* packed);
+    bool (*packB)(ConstMatrixView<T> B, int depth, int kc, int col, int nc, T* packed);
+};
+
+//Builds a kernel description whose packing matches its MR x NR shape
+template <int MR, int NR, typename T>
+GemmKernel<T> makeGemmKernel(const char* name, typename GemmKernel<T>::Micro micro,
+                             typename GemmKernel<T>::Micro microNarrow) {
+    return {name, MR, NR, micro, microNarrow, packStripsA<MR, T>, packStripsB<NR, T>};
+}
+
+// The kernels available for each element type; create() picks the widest the CPU supports
+template <typename T>
+struct GemmKernelFactory;
+
+template <>
+struct GemmKernelFactory<int64_t> {
+    static GemmKernel<int64_t> create() {
+#ifdef ALGORITHMS_X86_SIMD
+        if (cpuFeatures().avx512) {
+            return makeGemmKernel<6, 16, int64_t>("avx512", microKernelInt64Avx512, microKernelInt64NarrowAvx512);
+        }
+        if (cpuFeatures().avx2) {
+            return makeGemmKernel<6, 8, int64_t>("avx2", microKernelScalar<6, 8, int64_t>, microKernelInt64NarrowAvx2);
+        }
+#endif
+        return makeGemmKernel<4, 4, int64_t>("scalar", microKernelScalar<4, 4, int64_t>, microKernelScalar<4, 4, int64_t>);
+    }
+};
+
+template <>
+struct GemmKernelFactory<float> {
+    static GemmKernel<float> create() {
+#ifdef ALGORITHMS_X86_SIMD
+        if (cpuFeatures().avx512) return makeGemmKernel<6, 32, float>("avx512", microKernelFloatAvx512, microKernelFloatAvx512);
+        if (cpuFeatures().avx2) return makeGemmKernel<6, 16, float>("avx2", microKernelFloatAvx2, microKernelFloatAvx2);
+#endif
+        return makeGemmKernel<4, 4, float>("scalar", microKernelScalar<4, 4, float>, microKernelScalar<4, 4, float>);
+    }
+};
+
+template <>
+struct GemmKernelFactory<double> {
+    static GemmKernel<double> create() {
+#ifdef ALGORITHMS_X86_SIMD
+        if (cpuFeatures().avx512) return makeGemmKernel<6, 16, double>("avx512", microKernelDoubleAvx512, microKernelDoubleAvx512);
+        if (cpuFeatures().avx2) return makeGemmKernel<6, 8, double>("avx2", microKernelDoubleAvx2, microKernelDoubleAvx2);
+#endif
+        return makeGemmKernel<4, 4, double>("scalar", microKernelScalar<4, 4, double>, microKernelScalar<4, 4, double>);
+    }
+};
+
+template <uint32_t P>
+struct GemmKernelFactory<ModInt<P>> {
+    static GemmKernel<ModInt<P>> create() {
+#ifdef ALGORITHMS_X86_SIMD
+        if (cpuFeatures().avx512) {
+            return makeGemmKernel<6, 16, ModInt<P>>("avx512", microKernelModAvx512<P>, microKernelModAvx512<P>);
+        }
+#endif
+        return makeGemmKernel<4, 4, ModInt<P>>("scalar", microKernelModScalar<4, 4, P>, microKernelModScalar<4, 4, P>);
+    }
+};
+
+//Picks the widest kernel the CPU supports for this element type, once
+template <typename T>
+const GemmKernel<T>& selectGemmKernel() {
+    static const GemmKernel<T> kernel = GemmKernelFactory<T>::create();
+    return kernel;
+}
+
+// --- Blocked Multiply ---
+
+//Multiplies A (m x k) by B (k x n) with the packed kernel and writes (or, with 'accumulate', adds) the product into C (m x n)
+//This is the base case of Strassen's recursion and the whole of the classic multiply
+template <typename T>
+void blockedMultiply(ConstMatrixView<T> matrixA, ConstMatrixView<T> matrixB, MatrixView<T> matrixC, bool accumulate = false) {
+    const GemmKernel<T>& kernel = selectGemmKernel<T>();
+    int m = matrixC.rows, n = matrixC.cols, k = matrixA.cols;
+
+    if (k == 0) {
+        if (!accumulate) {
+            for (int i = 0; i < m; ++i) std::fill(matrixC[i], matrixC[i] + n, T());
+        }
+        return;
+    }
+
+    // Packing buffers live for the whole thread, so only the first multiply on a thread allocates them
+    thread_local std::vector<T> packedA, packedB;
+    packedA.resize((size_t)(GEMM_MC + kernel.mr) * GEMM_KC);
+    packedB.resize((size_t)(GEMM_NC + kernel.nr) * GEMM_KC);
+
+    T tile[GEMM_MAX_TILE]; // Scratch tile for the ragged right and bottom edges
+
+    for (int col = 0; col < n; col += GEMM_NC) {
+        int nc = std::min(GEMM_NC, n - col);
+        for (int depth = 0; depth < k; depth += GEMM_KC) {
+            int kc = std::min(GEMM_KC, k - depth);
+            bool addToC = accumulate || depth > 0;
+            bool narrowB = kernel.packB(matrixB, depth, kc, col, nc, packedB.data());
+
+            for (int row = 0; row < m; row += GEMM_MC) {
+                int mc = std::min(GEMM_MC, m - row);
+                bool narrowA = kernel.packA(matrixA, row, mc, depth, kc, packedA.data());
+                auto micro = (narrowA && narrowB) ? kernel.microNarrow : kernel.micro;
+
+                for (int jr = 0; jr < nc; jr += kernel.nr) {
+                    const T* b = packedB.data() + (size_t)jr * kc;
+                    int width = std::min(kernel.nr, nc - jr);
+                    for (int ir = 0; ir < mc; ir += kernel.mr) {
+                        const T* a = packedA.data() + (size_t)ir * kc;
+                        int height = std::min(kernel.mr, mc - ir);
+                        T* c = matrixC[row + ir] + col + jr;
+
+                        if (width == kernel.nr && height == kernel.mr) {
+                            micro(kc, a, b, c, matrixC.ld, addToC);
+                            continue;
+                        }
+
+                        // Partial tile: compute the full tile off to the side and copy the valid part
+                        micro(kc, a, b, tile, kernel.nr, false);
+                        for (int r = 0; r < height; ++r) {
+                            T* out = c + (size_t)r * matrixC.ld;
+                            for (int j = 0; j < width; ++j) {
+                                out[j] = addToC ? out[j] + tile[r * kernel.nr + j] : tile[r * kernel.nr + j];
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif
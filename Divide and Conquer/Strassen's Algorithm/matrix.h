@@ -0,0 +1,197 @@
+/**
+ * Dense matrix storage, strided views and the element types the Strassen engine supports.
+ *
+ * A Matrix<T> owns one contiguous row-major buffer. MatrixView<T> / ConstMatrixView<T> are
+ * (pointer, rows, cols, leading dimension) windows into such a buffer, so quadrants and
+ * other sub-blocks are addressed in place without copying.
+ *
+ * Element types:
+ *   int32_t      - inputs are 32-bit, products are computed and returned exactly in int64_t
+ *   int64_t      - exact as long as no intermediate sum overflows 64 bits
+ *   float/double - IEEE arithmetic (Strassen's extra additions cost a little accuracy)
+ *   ModInt<P>    - exact arithmetic modulo a prime P < 2^31
+*/
+
+#ifndef STRASSEN_MATRIX_H
+#define STRASSEN_MATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// --- Modular Integers ---
+
+/**
+ * @brief Integer modulo P, stored reduced in [0, P). P must be below 2^31 so that the sum of
+ * two residues fits in 32 bits and a product fits comfortably in 64.
+ */
+template <uint32_t P>
+struct ModInt {
+    static_assert(P > 1 && P < (1u << 31), "ModInt needs a modulus in (1, 2^31)");
+    static constexpr uint32_t MODULUS = P;
+
+    uint32_t value = 0;
+
+    ModInt() = default;
+    ModInt(long long v) : value((uint32_t)(((v % (long long)P) + (long long)P) % (long long)P)) {}
+
+    static ModInt fromReduced(uint32_t reduced) {
+        ModInt result;
+        result.value = reduced;
+        return result;
+    }
+
+    friend ModInt operator+(ModInt a, ModInt b) {
+        uint32_t sum = a.value + b.value;
+        return fromReduced(sum >= P ? sum - P : sum);
+    }
+    friend ModInt operator-(ModInt a, ModInt b) {
+        return fromReduced(a.value >= b.value ? a.value - b.value : a.value + P - b.value);
+    }
+    friend ModInt operator*(ModInt a, ModInt b) {
+        return fromReduced((uint32_t)((uint64_t)a.value * b.value % P));
+    }
+    ModInt operator-() const { return fromReduced(value == 0 ? 0 : P - value); }
+    ModInt& operator+=(ModInt other) { return *this = *this + other; }
+
+    friend bool operator==(ModInt a, ModInt b) { return a.value == b.value; }
+    friend bool operator!=(ModInt a, ModInt b) { return a.value != b.value; }
+    friend std::ostream& operator<<(std::ostream& out, ModInt a) { return out << a.value; }
+};
+
+// --- Element Traits ---
+
+/**
+ * @brief Per-type facts the engine needs: the type products are computed in (Result), the type
+ * a sum of all entries is reported in (Sum), and a short name used in profiles and messages.
+ */
+template <typename T>
+struct ElementTraits;
+
+template <>
+struct ElementTraits<int32_t> {
+    using Result = int64_t; // 32-bit inputs are multiplied exactly with 64-bit accumulation
+    using Sum = int64_t;
+    static std::string name() { return "int32"; }
+};
+
+template <>
+struct ElementTraits<int64_t> {
+    using Result = int64_t;
+    using Sum = int64_t;
+    static std::string name() { return "int64"; }
+};
+
+template <>
+struct ElementTraits<float> {
+    using Result = float;
+    using Sum = double;
+    static std::string name() { return "float"; }
+};
+
+template <>
+struct ElementTraits<double> {
+    using Result = double;
+    using Sum = double;
+    static std::string name() { return "double"; }
+};
+
+template <uint32_t P>
+struct ElementTraits<ModInt<P>> {
+    using Result = ModInt<P>;
+    using Sum = ModInt<P>;
+    static std::string name() { return "mod" + std::to_string(P); }
+};
+
+// Element type products of T matrices are computed in (int32_t inputs run in int64_t)
+template <typename T>
+using ResultType = typename ElementTraits<T>::Result;
+
+// --- Matrix Storage and Views ---
+
+/**
+ * @brief Non-owning window into row-major storage. Element (i, j) lives at data[i * ld + j],
+ * so a quadrant of a larger matrix is just a view with an offset pointer and the parent's
+ * leading dimension - no elements are copied.
+ */
+template <typename T>
+struct MatrixView {
+    T* data = nullptr;
+    int rows = 0;
+    int cols = 0;
+    int ld = 0; // Leading dimension: distance in elements between the starts of two rows
+
+    T* operator[](int i) const { return data + (size_t)i * ld; }
+
+    //Returns the r x c sub-block whose top-left corner is (row, col)
+    MatrixView block(int row, int col, int r, int c) const {
+        return {data + (size_t)row * ld + col, r, c, ld};
+    }
+
+    //Returns one of the four equal quadrants: 0 = top-left, 1 = top-right, 2 = bottom-left, 3 = bottom-right
+    MatrixView quadrant(int q) const {
+        int halfRows = rows / 2, halfCols = cols / 2;
+        return block((q / 2) * halfRows, (q % 2) * halfCols, halfRows, halfCols);
+    }
+};
+
+/**
+ * @brief Read-only counterpart of MatrixView. Any MatrixView converts to it implicitly.
+ */
+template <typename T>
+struct ConstMatrixView {
+    const T* data = nullptr;
+    int rows = 0;
+    int cols = 0;
+    int ld = 0;
+
+    ConstMatrixView() = default;
+    ConstMatrixView(const T* d, int r, int c, int l) : data(d), rows(r), cols(c), ld(l) {}
+    ConstMatrixView(const MatrixView<T>& v) : data(v.data), rows(v.rows), cols(v.cols), ld(v.ld) {}
+
+    const T* operator[](int i) const { return data + (size_t)i * ld; }
+
+    ConstMatrixView block(int row, int col, int r, int c) const {
+        return {data + (size_t)row * ld + col, r, c, ld};
+    }
+
+    ConstMatrixView quadrant(int q) const {
+        int halfRows = rows / 2, halfCols = cols / 2;
+        return block((q / 2) * halfRows, (q % 2) * halfCols, halfRows, halfCols);
+    }
+};
+
+/**
+ * @brief Dense matrix owning a single contiguous row-major buffer.
+ */
+template <typename T>
+struct Matrix {
+    int rows = 0;
+    int cols = 0;
+    std::vector<T> data;
+
+    Matrix() = default;
+    Matrix(int r, int c, T fill = T()) : rows(r), cols(c), data((size_t)r * c, fill) {}
+
+    bool empty() const { return data.empty(); }
+
+    T* operator[](int i) { return data.data() + (size_t)i * cols; }
+    const T* operator[](int i) const { return data.data() + (size_t)i * cols; }
+
+    MatrixView<T> view() { return {data.data(), rows, cols, cols}; }
+    ConstMatrixView<T> view() const { return {data.data(), rows, cols, cols}; }
+};
+
+//Converts every entry to another element type (used to widen int32 inputs to the int64 engine)
+template <typename To, typename From>
+Matrix<To> convertMatrix(const Matrix<From> &source) {
+    Matrix<To> result;
+    result.rows = source.rows;
+    result.cols = source.cols;
+    result.data.assign(source.data.begin(), source.data.end());
+    return result;
+}
+
+#endif
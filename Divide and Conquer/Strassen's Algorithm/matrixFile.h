@@ -0,0 +1,227 @@
+/**
+ * Readers for the matrix files of the Strassen program.
+ *
+ * A matrix file is either text, one {...} group per row inside an outer {...} (commas, spaces
+ * and anything else that is not a number or a brace only separate the entries), a flat list of
+ * numbers that forms a square matrix, or a binary rank-2 array written by --to-binary (see
+ * Common/fastInput.h). The readers live in a header so that every program that takes matrices,
+ * the batch solver included, accepts the same files.
+*/
+
+#ifndef STRASSEN_MATRIX_FILE_H
+#define STRASSEN_MATRIX_FILE_H
+
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../../Common/fastInput.h"
+#include "matrix.h"
+
+// What scanMatrixTokens reports: a number, or a brace at depth 2 opening or closing one row
+enum MatrixToken { TOKEN_NUMBER, TOKEN_ROW_OPEN, TOKEN_ROW_CLOSE };
+
+/**
+ * @brief Scans a mapped matrix file and calls onToken(token, value) for every number (and every
+ * row brace) in order. It is tolerant of C-style array formatting: commas, whitespace and
+ * anything else that is not a number or a brace separate the numbers. Integer element types use
+ * the SIMD integer scanner; floating-point types also accept decimals and exponents.
+ * Returns false and explains why in 'problem' if a number is out of range, which for int32_t
+ * elements means outside INT32_MIN..INT32_MAX.
+ */
+template <typename T, typename TokenHandler>
+bool scanMatrixTokens(const MappedFile& file, TokenHandler onToken, std::string& problem) {
+    IntegerScanner scanner(file.data(), file.end());
+    int depth = 0;
+    
+    // The braces between two numbers close rows first, then open new ones ("}, {")
+    auto crossBraces = [&]() {
+        int lowest = depth - scanner.closed();
+        if (depth >= 2 && lowest < 2) onToken(TOKEN_ROW_CLOSE, T());
+        depth = scanner.depth();
+        if (lowest < 2 && depth >= 2) onToken(TOKEN_ROW_OPEN, T());
+    };
+
+    size_t entries = 0;
+    while (true) {
+        T val;
+        bool found;
+        if constexpr (std::is_floating_point<T>::value) {
+            double number = 0; // left unset at the end of the input
+            found = scanner.nextReal(number);
+            val = (T)number;
+        } else {
+            int64_t number = 0;
+            found = scanner.next(number);
+            if constexpr (std::is_same<T, int32_t>::value) {
+                if (found && (number < INT32_MIN || number > INT32_MAX)) {
+                    problem = "entry " + std::to_string(entries + 1) + " (" + std::to_string(number) +
+                              ") does not fit in int32 (pass --type int64)";
+                    return false;
+                }
+            }
+            val = T(number); // ModInt reduces the value
+        }
+        entries += found;
+        if (scanner.overflowed()) {
+            problem = numberOverflowError(scanner);
+            return false;
+        }
+        crossBraces();
+        if (!found) break;
+        onToken(TOKEN_NUMBER, val);
+    }
+    return true;
+}
+
+/**
+ * @brief Streams a matrix file row by row: onRow(row) is called with each row (cols entries)
+ * as soon as it has been parsed, so the matrix is never held in memory. Each inner {...} group
+ * is one row, so rectangular matrices are supported; a flat list of numbers must form a square
+ * matrix (which takes a second pass to find its size). Floating-point element types also accept
+ * decimals and exponents. The file is memory-mapped, and binary matrices (rank-2 arrays, see
+ * Common/fastInput.h) are read without any parsing. On return 'rows' and 'cols' hold the shape. Returns false after
+ * explaining the problem if the file is malformed; rows delivered before that are meaningless.
+ */
+template <typename T, typename RowHandler>
+bool streamMatrixFromFile(const std::string& filename, int& rows, int& cols, RowHandler onRow) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Error: Could not open file " << filename << ". Please ensure the file exists." << std::endl;
+        return false;
+    }
+
+    if (hasBinaryMagic(file.data(), file.size())) {
+        BinaryArray array;
+        std::string problem;
+        if (!parseBinaryArray(file.data(), file.size(), array, problem) || array.dims.size() != 2 || array.count == 0) {
+            std::cerr << "Error: " << filename << " is not a binary matrix"
+                      << (problem.empty() ? std::string(" (it must be a non-empty rank-2 array).") : ": " + problem + ".") << std::endl;
+            return false;
+        }
+        if (array.dims[0] > INT_MAX || array.dims[1] > INT_MAX) {
+            std::cerr << "Error: " << filename << " has a corrupt header (a " << array.dims[0] << "x" << array.dims[1]
+                      << " matrix is larger than the programs support)." << std::endl;
+            return false;
+        }
+        rows = (int)array.dims[0];
+        cols = (int)array.dims[1];
+        std::vector<T> row(cols);
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                size_t entry = (size_t)i * cols + j;
+                if constexpr (std::is_same<T, int32_t>::value) {
+                    // An int64 file may hold entries that int32 cannot
+                    int64_t wide = array.get<int64_t>(entry);
+                    if (array.elementType == BINARY_INT64 && (wide < INT32_MIN || wide > INT32_MAX)) {
+                        std::cerr << "Error: Matrix in " << filename << ": entry " << entry + 1 << " (" << wide
+                                  << ") does not fit in int32 (pass --type int64)." << std::endl;
+                        return false;
+                    }
+                }
+                row[j] = array.get<T>(entry);
+            }
+            onRow((const T*)row.data());
+        }
+        return true;
+    }
+
+    std::vector<T> row;
+    bool inRow = false;
+    bool sawRows = false;
+    size_t total_elements = 0, loose_elements = 0, bad_length = 0;
+    rows = 0;
+    cols = -1;
+    std::string problem;
+    auto scanFailed = [&] {
+        std::cerr << "Error: Matrix in " << filename << ": " << problem << "." << std::endl;
+        return false;
+    };
+
+    bool scanned = scanMatrixTokens<T>(file, [&](MatrixToken token, T value) {
+        if (token == TOKEN_ROW_OPEN) {
+            inRow = sawRows = true;
+            row.clear();
+        } else if (token == TOKEN_NUMBER) {
+            ++total_elements;
+            if (inRow) row.push_back(value);
+            else ++loose_elements;
+        } else {
+            inRow = false;
+            if (cols < 0) cols = (int)row.size();
+            // Every row must have the same number of entries
+            if (row.size() != (size_t)cols) {
+                if (bad_length == 0) bad_length = row.size() + 1;
+                return;
+            }
+            if (bad_length == 0 && cols > 0) onRow((const T*)row.data());
+            ++rows;
+        }
+    }, problem);
+    if (!scanned) return scanFailed();
+
+    if (total_elements == 0) {
+        std::cerr << "Error: Matrix in " << filename << " is empty or contains no valid numbers." << std::endl;
+        return false;
+    }
+    
+    if (sawRows) {
+        if (bad_length != 0) {
+            std::cerr << "Error: Matrix in " << filename << " has rows of different lengths ("
+                      << cols << " and " << bad_length - 1 << ")." << std::endl;
+            return false;
+        }
+        if (inRow) {
+            std::cerr << "Error: Matrix in " << filename << " ends inside a row (a closing brace is missing)." << std::endl;
+            return false;
+        }
+        if (loose_elements != 0 || rows == 0 || cols <= 0) {
+            std::cerr << "Error: Matrix in " << filename << " has numbers outside of its rows." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    int n = (int)std::round(std::sqrt(total_elements));
+    
+    // Without row braces the total number of elements must form a perfect square matrix (n x n)
+    if ((size_t)n * n != total_elements) {
+        std::cerr << "Error: Matrix in " << filename << " has " << total_elements 
+                  << " elements, which cannot form a square matrix (N x N)." << std::endl;
+        return false;
+    }
+    rows = cols = n;
+
+    // Second pass: now that the size is known, cut the number list into rows
+    row.clear();
+    scanned = scanMatrixTokens<T>(file, [&](MatrixToken token, T value) {
+        if (token != TOKEN_NUMBER) return;
+        row.push_back(value);
+        if ((int)row.size() == n) {
+            onRow((const T*)row.data());
+            row.clear();
+        }
+    }, problem);
+    return scanned || scanFailed();
+}
+
+/**
+ * @brief Reads a whole matrix from a file (see streamMatrixFromFile for the accepted formats).
+ * Returns an empty matrix if the file is missing or malformed.
+ */
+template <typename T>
+Matrix<T> readMatrixFromFile(const std::string& filename) {
+    Matrix<T> M;
+    bool ok = streamMatrixFromFile<T>(filename, M.rows, M.cols, [&](const T* row) {
+        M.data.insert(M.data.end(), row, row + M.cols);
+    });
+    if (!ok) return {};
+    
+    return M;
+}
+
+#endif
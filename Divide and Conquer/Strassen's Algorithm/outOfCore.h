@@ -0,0 +1,364 @@
+/**
+ * Out-of-core multiplication for matrices that do not fit in memory.
+ *
+ * A tiled matrix file stores a matrix as square tile x tile blocks, each one contiguous and
+ * zero-padded past the right and bottom edges, so every tile is a single page-aligned range:
+ *   header:  magic "ALGOTIL1", element type (the codes of Common/fastInput.h) and tile size as
+ *            uint32, rows and cols as uint64
+ *   tiles:   row-major tile order, starting at byte TILED_DATA_OFFSET
+ *
+ * multiplyTiled memory-maps A, B and C and forms C one tile at a time,
+ * C(i, j) = sum over p of A(i, p) * B(p, j), with the Strassen engine on each tile product.
+ * Only a few tiles are resident at once: the pair being multiplied, the next pair (prefetched
+ * with madvise(MADV_WILLNEED) while the current product runs), the C tile and the scratch of
+ * one tile product. Tiles are dropped from the mapping as soon as they have been used, so the
+ * memory needed depends on the tile size (see tileSizeForBudget), not on the matrices.
+*/
+
+#ifndef STRASSEN_OUT_OF_CORE_H
+#define STRASSEN_OUT_OF_CORE_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../../Common/fastInput.h"
+#include "productReductions.h"
+#include "strassen.h"
+
+const char TILED_MAGIC[8] = {'A', 'L', 'G', 'O', 'T', 'I', 'L', '1'};
+const size_t TILED_DATA_OFFSET = 4096; // One page, so every tile starts page-aligned
+const int TILE_GRANULARITY = 64;       // Tile sizes are multiples of this (64 x 64 x 4 bytes is a whole number of pages)
+
+// --- Tiled Matrix Files ---
+
+/**
+ * @brief A memory-mapped tiled matrix file, either opened read-only or created for writing.
+ */
+template <typename T>
+class TiledMatrixFile {
+    static_assert(std::is_arithmetic<T>::value, "Tiled files hold int32, int64, float or double elements");
+
+public:
+    TiledMatrixFile() = default;
+    ~TiledMatrixFile() { close(); }
+
+    TiledMatrixFile(const TiledMatrixFile&) = delete;
+    TiledMatrixFile& operator=(const TiledMatrixFile&) = delete;
+
+    //Creates a zero-filled rows x cols file. Returns false and explains why in 'error' on failure.
+    bool create(const std::string& filename, int rows, int cols, int tile, std::string& error) {
+        close();
+        if (rows <= 0 || cols <= 0 || tile <= 0 || tile % TILE_GRANULARITY != 0) {
+            error = "a tiled matrix needs a positive shape and a tile size that is a multiple of " +
+                    std::to_string(TILE_GRANULARITY);
+            return false;
+        }
+        setShape(rows, cols, tile);
+#ifdef ALGORITHMS_HAVE_MMAP
+        int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || ftruncate(fd, (off_t)length) != 0) {
+            if (fd >= 0) ::close(fd);
+            error = "Could not create " + filename;
+            return false;
+        }
+        void* mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            error = "Could not map " + filename;
+            return false;
+        }
+        mapping = (char*)mapped;
+
+        uint32_t type = binaryElementType<T>(), tileSize = (uint32_t)tile;
+        uint64_t shape[2] = {(uint64_t)rows, (uint64_t)cols};
+        std::memcpy(mapping, TILED_MAGIC, sizeof(TILED_MAGIC));
+        std::memcpy(mapping + 8, &type, 4);
+        std::memcpy(mapping + 12, &tileSize, 4);
+        std::memcpy(mapping + 16, shape, sizeof(shape));
+        return true;
+#else
+        error = "Out-of-core files need mmap, which this platform does not provide";
+        return false;
+#endif
+    }
+
+    //Opens an existing file read-only. Returns false and explains why in 'error' if it is not a tiled file of T.
+    bool open(const std::string& filename, std::string& error) {
+        close();
+#ifdef ALGORITHMS_HAVE_MMAP
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            if (fd >= 0) ::close(fd);
+            error = "Could not open file " + filename;
+            return false;
+        }
+        size_t size = (size_t)info.st_size;
+        void* mapped = size >= TILED_DATA_OFFSET ? mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+        ::close(fd);
+        if (mapped == MAP_FAILED || std::memcmp(mapped, TILED_MAGIC, sizeof(TILED_MAGIC)) != 0) {
+            if (mapped != MAP_FAILED) munmap(mapped, size);
+            error = filename + " is not a tiled matrix file (convert it with --to-tiled)";
+            return false;
+        }
+        mapping = (char*)mapped;
+        length = size;
+
+        uint32_t type, tile;
+        uint64_t shape[2];
+        std::memcpy(&type, mapping + 8, 4);
+        std::memcpy(&tile, mapping + 12, 4);
+        std::memcpy(shape, mapping + 16, sizeof(shape));
+        if (type != binaryElementType<T>()) {
+            close();
+            error = filename + " holds a different element type (pass the matching --type)";
+            return false;
+        }
+        if (tile == 0 || tile % TILE_GRANULARITY != 0 || tile > INT_MAX || shape[0] == 0 || shape[1] == 0 ||
+            shape[0] > INT_MAX || shape[1] > INT_MAX) {
+            close();
+            error = filename + " has a corrupt header";
+            return false;
+        }
+        // Checked in steps so that no product of header fields can overflow before it is compared
+        const uint64_t tileArea = (uint64_t)tile * tile;
+        const uint64_t tileCount = ((shape[0] + tile - 1) / tile) * ((shape[1] + tile - 1) / tile);
+        const uint64_t dataElements = (size - TILED_DATA_OFFSET) / sizeof(T);
+        bool truncated = tileArea > dataElements || tileCount > dataElements / tileArea;
+        if (!truncated) setShape((int)shape[0], (int)shape[1], (int)tile);
+        length = size; // Unmap exactly what was mapped
+        if (truncated) {
+            close();
+            error = filename + " is shorter than its header says";
+            return false;
+        }
+        return true;
+#else
+        error = "Out-of-core files need mmap, which this platform does not provide";
+        return false;
+#endif
+    }
+
+    void close() {
+#ifdef ALGORITHMS_HAVE_MMAP
+        if (mapping != nullptr) munmap(mapping, length);
+#endif
+        mapping = nullptr;
+        length = 0;
+    }
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    int tile() const { return tileSize; }
+    int tileRows() const { return (rowCount + tileSize - 1) / tileSize; }
+    int tileCols() const { return (colCount + tileSize - 1) / tileSize; }
+
+    //Tile (i, j) as a tile x tile view straight into the mapping (writable only for created files)
+    MatrixView<T> tileView(int i, int j) const {
+        return {(T*)tileAddress(i, j), tileSize, tileSize, tileSize};
+    }
+
+    //Asks the kernel to start reading tile (i, j) in the background
+    void prefetch(int i, int j) const { advise(i, j, true); }
+
+    //Drops tile (i, j) from this process's memory; it is read back (or, if written, kept by the page cache) on the next access
+    void evict(int i, int j) const { advise(i, j, false); }
+
+    //Starts writing a finished tile back to the file
+    void flush(int i, int j) const {
+#ifdef ALGORITHMS_HAVE_MMAP
+        msync(tileAddress(i, j), tileBytes(), MS_ASYNC);
+#endif
+    }
+
+private:
+    void setShape(int rows, int cols, int tile) {
+        rowCount = rows;
+        colCount = cols;
+        tileSize = tile;
+        length = TILED_DATA_OFFSET + (size_t)tileRows() * tileCols() * tileBytes();
+    }
+
+    size_t tileBytes() const { return (size_t)tileSize * tileSize * sizeof(T); }
+
+    char* tileAddress(int i, int j) const {
+        return mapping + TILED_DATA_OFFSET + ((size_t)i * tileCols() + j) * tileBytes();
+    }
+
+    void advise(int i, int j, bool willNeed) const {
+#ifdef ALGORITHMS_HAVE_MMAP
+        madvise(tileAddress(i, j), tileBytes(), willNeed ? MADV_WILLNEED : MADV_DONTNEED);
+#endif
+    }
+
+    char* mapping = nullptr;
+    size_t length = 0;
+    int rowCount = 0;
+    int colCount = 0;
+    int tileSize = 0;
+};
+
+// --- Budgeting ---
+
+//Options the tile products of multiplyTiled run with; 'depth' receives their parallel depth
+//(0 when they run serially)
+inline StrassenOptions tiledProductOptions(const StrassenOptions &options, int &depth) {
+    StrassenOptions resolved = options;
+    if (resolved.cutoff <= 0) resolved.cutoff = DEFAULT_STRASSEN_CUTOFF;
+    depth = 0;
+    if (options.threads > 1 && resolved.algorithm != MultiplyAlgorithm::Classic) {
+        depth = options.parallelDepth >= 0 ? options.parallelDepth : defaultParallelDepth(options.threads);
+    }
+    return resolved;
+}
+
+/**
+ * @brief Bytes multiplyTiled keeps resident for 'tile' x 'tile' tiles: four input tiles (the
+ * current pair and the prefetched pair), the C tile, one tile product and the Strassen scratch
+ * of the serial or parallel recursion 'options' asks for, plus widened copies of the inputs
+ * when T is narrower than the result type.
+ */
+template <typename T>
+size_t tiledWorkingSetBytes(int tile, const StrassenOptions &options) {
+    using R = ResultType<T>;
+    int depth = 0;
+    StrassenOptions resolved = tiledProductOptions(options, depth);
+    size_t area = (size_t)tile * tile;
+    size_t bytes = area * (4 * sizeof(T) + 2 * sizeof(R));
+    if (sizeof(T) != sizeof(R)) bytes += 2 * area * sizeof(R);
+    return bytes + strassenParallelWorkspaceSize(tile, tile, tile, depth, resolved) * sizeof(R);
+}
+
+/**
+ * @brief Largest tile size (a multiple of TILE_GRANULARITY, at least one granule) whose
+ * working set under 'options' fits in 'budgetBytes'. The parallel recursion needs several
+ * times the scratch of the serial one, so the thread count shrinks the tile.
+ */
+template <typename T>
+int tileSizeForBudget(size_t budgetBytes, const StrassenOptions &options = StrassenOptions()) {
+    // The working set is a few tiles' worth, so the square root of the budget over the tiles'
+    // bytes per element is an upper bound to step down from
+    size_t perElement = 4 * sizeof(T) + 2 * sizeof(ResultType<T>);
+    int tile = (int)std::min(std::sqrt((double)budgetBytes / (double)perElement), (double)INT_MAX / 2);
+    tile = tile / TILE_GRANULARITY * TILE_GRANULARITY;
+    while (tile > TILE_GRANULARITY && tiledWorkingSetBytes<T>(tile, options) > budgetBytes) tile -= TILE_GRANULARITY;
+    return std::max(TILE_GRANULARITY, tile);
+}
+
+/**
+ * @brief Shrinks 'tile' to the matrix itself (max(rows, cols) rounded up to TILE_GRANULARITY),
+ * so that a matrix smaller than the budget's tile is not stored, and multiplied, as one mostly
+ * zero tile.
+ */
+inline int clampTileToShape(int tile, int rows, int cols) {
+    long long extent = std::max(rows, cols);
+    long long rounded = (extent + TILE_GRANULARITY - 1) / TILE_GRANULARITY * TILE_GRANULARITY;
+    return (int)std::min<long long>(tile, rounded);
+}
+
+// --- Multiplication ---
+
+/**
+ * @brief C = A * B over tiled files. A, B and C must share one tile size and C must already
+ * be created with A's rows, B's cols and the result type (its tiles start out zero).
+ * Tile products run serially or on a pool, exactly as strassenMultiply would run them; tiles on
+ * the right and bottom edges are multiplied as blocks of their real rows and columns, so the
+ * zero padding costs no arithmetic.
+ */
+template <typename T>
+void multiplyTiled(const TiledMatrixFile<T> &matrixA, const TiledMatrixFile<T> &matrixB,
+                   TiledMatrixFile<ResultType<T>> &matrixC, const StrassenOptions &options = StrassenOptions()) {
+    using R = ResultType<T>;
+    if (matrixA.cols() != matrixB.rows() || matrixC.rows() != matrixA.rows() || matrixC.cols() != matrixB.cols()) {
+        throw std::runtime_error("Error: Cannot multiply a " + std::to_string(matrixA.rows()) + "x" +
+                                 std::to_string(matrixA.cols()) + " matrix by a " + std::to_string(matrixB.rows()) +
+                                 "x" + std::to_string(matrixB.cols()) + " matrix.");
+    }
+    if (matrixA.tile() != matrixB.tile() || matrixA.tile() != matrixC.tile()) {
+        throw std::runtime_error("Error: Tiled operands must share one tile size (convert them with the same --tile).");
+    }
+
+    const int tile = matrixA.tile();
+    int depth = 0;
+    StrassenOptions resolved = tiledProductOptions(options, depth);
+    std::unique_ptr<ThreadPool> pool;
+    if (depth > 0) pool = helperPool(options.threads);
+    StrassenWorkspace<R> workspace(strassenParallelWorkspaceSize(tile, tile, tile, depth, resolved));
+    std::vector<R> product((size_t)tile * tile), widenedA, widenedB;
+    MatrixView<R> productView{product.data(), tile, tile, tile};
+
+    const int tileRows = matrixA.tileRows(), tileCols = matrixB.tileCols(), inner = matrixA.tileCols();
+    matrixA.prefetch(0, 0);
+    matrixB.prefetch(0, 0);
+    for (int i = 0; i < tileRows; ++i) {
+        for (int j = 0; j < tileCols; ++j) {
+            const int height = std::min(tile, matrixA.rows() - i * tile);
+            const int width = std::min(tile, matrixB.cols() - j * tile);
+            MatrixView<R> tileC = matrixC.tileView(i, j).block(0, 0, height, width);
+            MatrixView<R> blockProduct = productView.block(0, 0, height, width);
+            for (int p = 0; p < inner; ++p) {
+                const int depthP = std::min(tile, matrixA.cols() - p * tile);
+                // Start reading the next pair while this one is multiplied
+                if (p + 1 < inner) {
+                    matrixA.prefetch(i, p + 1);
+                    matrixB.prefetch(p + 1, j);
+                } else if (j + 1 < tileCols || i + 1 < tileRows) {
+                    matrixA.prefetch(j + 1 < tileCols ? i : i + 1, 0);
+                    matrixB.prefetch(0, j + 1 < tileCols ? j + 1 : 0);
+                }
+
+                ConstMatrixView<T> blockA = matrixA.tileView(i, p).block(0, 0, height, depthP);
+                ConstMatrixView<T> blockB = matrixB.tileView(p, j).block(0, 0, depthP, width);
+                ConstMatrixView<R> tileA, tileB;
+                if constexpr (std::is_same<T, R>::value) {
+                    tileA = blockA;
+                    tileB = blockB;
+                } else {
+                    tileA = copyAsResultType<R>(blockA, widenedA);
+                    tileB = copyAsResultType<R>(blockB, widenedB);
+                }
+
+                if (resolved.algorithm == MultiplyAlgorithm::Classic) {
+                    blockedMultiply<R>(tileA, tileB, tileC, true);
+                } else {
+                    if (depth == 0) {
+                        serialMultiplyRecursive<R>(tileA, tileB, blockProduct, workspace, resolved.algorithm, resolved.cutoff);
+                    } else {
+                        strassenMultiplyParallel<R>(tileA, tileB, blockProduct, workspace, *pool, depth, resolved);
+                    }
+                    matrixAccumulate<R>(tileC, blockProduct);
+                }
+                matrixA.evict(i, p);
+                matrixB.evict(p, j);
+            }
+            matrixC.flush(i, j);
+            matrixC.evict(i, j);
+        }
+    }
+}
+
+//Sum of all entries of a tiled matrix, read one tile at a time (the zero padding adds nothing)
+template <typename T>
+ReductionType<T> tiledMatrixSum(const TiledMatrixFile<T> &matrix) {
+    ReductionType<T> total = ReductionType<T>();
+    for (int i = 0; i < matrix.tileRows(); ++i) {
+        for (int j = 0; j < matrix.tileCols(); ++j) {
+            MatrixView<T> tile = matrix.tileView(i, j);
+            for (int r = 0; r < tile.rows; ++r) {
+                for (int c = 0; c < tile.cols; ++c) total = reductionAdd(total, ReductionType<T>(tile[r][c]));
+            }
+            matrix.evict(i, j);
+        }
+    }
+    return total;
+}
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * Reductions of a matrix product C = A * B computed straight from A and B, without ever
+ * forming C:
+ *   sum(C)          = columnSums(A) . rowSums(B)              O(mk + kn) time, O(k) memory
+ *   rowSums(C)      = A * rowSums(B)                          O(mk + kn) time, O(m + k) memory
+ *   columnSums(C)   = columnSums(A) * B                       O(mk + kn) time, O(k + n) memory
+ *   trace(C)        = sum over i, p of A[i][p] * B[p][i]      O(mk) time, no extra memory
+ *   ||C||_F         = rows of C formed one band at a time     O(mkn) time, O(n) memory
+ * The Frobenius norm has no shortcut (it depends on every entry of C), so it still costs a full
+ * multiply; it only avoids keeping C in memory.
+ *
+ * Every routine also comes in an "accumulate" form that consumes A or B a band of rows at a time,
+ * which is what lets strassen.cpp reduce two files while streaming them.
+ *
+ * Integer results are reported in int64_t with the same modulo 2^64 wrap-around a materialised
+ * product would show; ModInt results are exact modulo P.
+*/
+
+#ifndef STRASSEN_PRODUCT_REDUCTIONS_H
+#define STRASSEN_PRODUCT_REDUCTIONS_H
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "gemmKernels.h"
+#include "matrix.h"
+
+// Type every reduction of a product of T matrices is reported in
+template <typename T>
+using ReductionType = typename ElementTraits<T>::Sum;
+
+//Sum and product that wrap modulo 2^64 for integers instead of overflowing
+template <typename S>
+S reductionAdd(S a, S b) {
+    if constexpr (std::is_integral<S>::value) return (S)((std::make_unsigned_t<S>)a + (std::make_unsigned_t<S>)b);
+    else return a + b;
+}
+
+template <typename S>
+S reductionMultiply(S a, S b) {
+    if constexpr (std::is_integral<S>::value) return (S)((std::make_unsigned_t<S>)a * (std::make_unsigned_t<S>)b);
+    else return a * b;
+}
+
+//Dot product of two equally long vectors
+template <typename S>
+S dotProduct(const std::vector<S> &x, const std::vector<S> &y) {
+    S total = S();
+    for (size_t i = 0; i < x.size(); ++i) total = reductionAdd(total, reductionMultiply(x[i], y[i]));
+    return total;
+}
+
+// --- Marginals of One Matrix ---
+
+//Adds the column sums of M onto 'sums' (which is sized on first use)
+template <typename T>
+void accumulateColumnSums(ConstMatrixView<T> M, std::vector<ReductionType<T>> &sums) {
+    sums.resize(M.cols);
+    for (int i = 0; i < M.rows; ++i) {
+        const T* row = M[i];
+        for (int j = 0; j < M.cols; ++j) sums[j] = reductionAdd(sums[j], ReductionType<T>(row[j]));
+    }
+}
+
+//Appends the sum of every row of M to 'sums'
+template <typename T>
+void accumulateRowSums(ConstMatrixView<T> M, std::vector<ReductionType<T>> &sums) {
+    for (int i = 0; i < M.rows; ++i) {
+        ReductionType<T> total = ReductionType<T>();
+        const T* row = M[i];
+        for (int j = 0; j < M.cols; ++j) total = reductionAdd(total, ReductionType<T>(row[j]));
+        sums.push_back(total);
+    }
+}
+
+template <typename T>
+std::vector<ReductionType<T>> columnSums(ConstMatrixView<T> M) {
+    std::vector<ReductionType<T>> sums;
+    accumulateColumnSums(M, sums);
+    return sums;
+}
+
+template <typename T>
+std::vector<ReductionType<T>> rowSums(ConstMatrixView<T> M) {
+    std::vector<ReductionType<T>> sums;
+    accumulateRowSums(M, sums);
+    return sums;
+}
+
+// --- Reductions of the Product, One Band of Rows at a Time ---
+
+//Appends the row sums of (band of A) * B, given rowSums(B)
+template <typename T>
+void accumulateProductRowSums(ConstMatrixView<T> bandA, const std::vector<ReductionType<T>> &rowSumsB,
+                              std::vector<ReductionType<T>> &out) {
+    for (int i = 0; i < bandA.rows; ++i) {
+        ReductionType<T> total = ReductionType<T>();
+        const T* row = bandA[i];
+        for (int p = 0; p < bandA.cols; ++p) {
+            total = reductionAdd(total, reductionMultiply(ReductionType<T>(row[p]), rowSumsB[p]));
+        }
+        out.push_back(total);
+    }
+}
+
+//Adds the contribution of rows [firstRow, firstRow + bandB.rows) of B to the column sums of A * B, given columnSums(A)
+template <typename T>
+void accumulateProductColumnSums(ConstMatrixView<T> bandB, int firstRow, const std::vector<ReductionType<T>> &columnSumsA,
+                                 std::vector<ReductionType<T>> &out) {
+    out.resize(bandB.cols);
+    for (int p = 0; p < bandB.rows; ++p) {
+        ReductionType<T> weight = columnSumsA[firstRow + p];
+        const T* row = bandB[p];
+        for (int j = 0; j < bandB.cols; ++j) {
+            out[j] = reductionAdd(out[j], reductionMultiply(weight, ReductionType<T>(row[j])));
+        }
+    }
+}
+
+//Diagonal entries firstRow, firstRow + 1, ... of A * B contributed by a band of rows of A
+template <typename T>
+ReductionType<T> productTraceOfBand(ConstMatrixView<T> bandA, int firstRow, ConstMatrixView<T> B) {
+    ReductionType<T> total = ReductionType<T>();
+    for (int i = 0; i < bandA.rows; ++i) {
+        const T* row = bandA[i];
+        for (int p = 0; p < bandA.cols; ++p) {
+            total = reductionAdd(total, reductionMultiply(ReductionType<T>(row[p]), ReductionType<T>(B[p][firstRow + i])));
+        }
+    }
+    return total;
+}
+
+//Copies a view into contiguous storage of the result type (int32_t entries are widened to int64_t)
+template <typename R, typename T>
+ConstMatrixView<R> copyAsResultType(ConstMatrixView<T> M, std::vector<R> &storage) {
+    storage.resize((size_t)M.rows * M.cols);
+    for (int i = 0; i < M.rows; ++i) std::copy(M[i], M[i] + M.cols, storage.data() + (size_t)i * M.cols);
+    return {storage.data(), M.rows, M.cols, M.cols};
+}
+
+//Sum of the squares of the entries of (band of A) * B. The band's product is formed in 'bandC'
+//(bandA.rows x B.cols), so the memory needed is one band of C rather than all of it.
+template <typename T>
+double productSquaresOfBand(ConstMatrixView<T> bandA, ConstMatrixView<ResultType<T>> B,
+                            std::vector<ResultType<T>> &bandC, std::vector<ResultType<T>> &widenedA) {
+    static_assert(std::is_arithmetic<T>::value, "The Frobenius norm needs a numeric element type");
+    ConstMatrixView<ResultType<T>> A;
+    if constexpr (std::is_same<T, ResultType<T>>::value) A = bandA;
+    else A = copyAsResultType(bandA, widenedA);
+
+    bandC.resize((size_t)A.rows * B.cols);
+    blockedMultiply(A, B, MatrixView<ResultType<T>>{bandC.data(), A.rows, B.cols, B.cols});
+
+    double total = 0;
+    for (ResultType<T> value : bandC) total += (double)value * (double)value;
+    return total;
+}
+
+// --- Whole-Matrix Reductions ---
+
+//sum(A * B) = columnSums(A) . rowSums(B)
+template <typename T>
+ReductionType<T> productSum(ConstMatrixView<T> A, ConstMatrixView<T> B) {
+    return dotProduct(columnSums(A), rowSums(B));
+}
+
+template <typename T>
+std::vector<ReductionType<T>> productRowSums(ConstMatrixView<T> A, ConstMatrixView<T> B) {
+    std::vector<ReductionType<T>> out;
+    accumulateProductRowSums(A, rowSums(B), out);
+    return out;
+}
+
+template <typename T>
+std::vector<ReductionType<T>> productColumnSums(ConstMatrixView<T> A, ConstMatrixView<T> B) {
+    std::vector<ReductionType<T>> out;
+    accumulateProductColumnSums(B, 0, columnSums(A), out);
+    return out;
+}
+
+//trace(A * B); the product must be square
+template <typename T>
+ReductionType<T> productTrace(ConstMatrixView<T> A, ConstMatrixView<T> B) {
+    if (A.rows != B.cols) {
+        throw std::runtime_error("Error: The trace is only defined for a square product.");
+    }
+    return productTraceOfBand(A, 0, B);
+}
+
+//||A * B||_F, computed GEMM_MC rows of the product at a time
+template <typename T>
+double productFrobeniusNorm(ConstMatrixView<T> A, ConstMatrixView<T> B) {
+    std::vector<ResultType<T>> widenedB, bandC, widenedA;
+    ConstMatrixView<ResultType<T>> wideB;
+    if constexpr (std::is_same<T, ResultType<T>>::value) wideB = B;
+    else wideB = copyAsResultType(B, widenedB);
+
+    double total = 0;
+    for (int row = 0; row < A.rows; row += GEMM_MC) {
+        int rows = std::min(GEMM_MC, A.rows - row);
+        total += productSquaresOfBand(A.block(row, 0, rows, A.cols), wideB, bandC, widenedA);
+    }
+    return std::sqrt(total);
+}
+
+#endif
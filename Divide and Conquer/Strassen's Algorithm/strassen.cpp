@@ -1,7 +1,7 @@
 /** 
  * This algorithm will take two files as input
  * Each input files will have data that will form a matrix
- * The matricies are multiplied using Strassen's Algorithm 
+ * The matricies (square or rectangular) are multiplied using Strassen's Algorithm 
  * The output will be the sum of all the entries in the resulting matrix
 */
 
@@ -14,347 +14,699 @@
 #include <cmath>
 #include <algorithm>
 #include <stdexcept> // For runtime_error
+#include <chrono>
+#include <random>
+#include <cctype>
+#include <cstdlib>
+#include <cstdint>
+#include <iomanip>
+#include <type_traits>
+
+#include "../../Common/fastInput.h"
+#include "batchedMultiply.h"
+#include "matrixFile.h"
+#include "outOfCore.h"
+#include "productReductions.h"
+#include "strassen.h"
 
 using namespace std;
-using Matrix = vector<vector<int>>;
 
-// --- File Reading Functions ---
+// --- Fused Reductions Straight From the Files ---
+
+// Reductions main can print; all but the Frobenius norm cost only O(n^2) time (see productReductions.h)
+enum class ProductReduction { Sum, Trace, RowSums, ColumnSums, Frobenius };
+
+//Parses a --reduce argument; returns false for an unknown name
+bool parseReduction(const string& name, ProductReduction& reduction) {
+    if (name == "sum") reduction = ProductReduction::Sum;
+    else if (name == "trace") reduction = ProductReduction::Trace;
+    else if (name == "rowsums") reduction = ProductReduction::RowSums;
+    else if (name == "colsums") reduction = ProductReduction::ColumnSums;
+    else if (name == "frobenius") reduction = ProductReduction::Frobenius;
+    else return false;
+    return true;
+}
+
+template <typename S>
+void printValues(const vector<S>& values) {
+    for (size_t i = 0; i < values.size(); ++i) cout << (i ? " " : "") << values[i];
+}
 
 /**
- * @brief Reads a matrix from a file. It is now tolerant of C-style array formatting 
- * (commas and curly braces) which are replaced by spaces before parsing.
- * Checks for square matrices.
+ * @brief Computes a reduction of A * B while streaming the two files, without forming the product.
+ * Sums and row/column sums keep O(n) numbers in memory. The trace and the Frobenius norm need
+ * entries of B in arbitrary order, so B is read into memory and only A is streamed; the
+ * Frobenius norm forms GEMM_MC rows of the product at a time.
+ * Returns the process exit code.
  */
-Matrix readMatrixFromFile(const string& filename) {
-    ifstream file(filename);
-    
-    if (!file.is_open()) {
-        cerr << "Error: Could not open file " << filename << ". Please ensure the file exists." << endl;
-        return {};
+template <typename T>
+int reduceProductFromFiles(ProductReduction reduction, const string& filenameA, const string& filenameB) {
+    using S = ReductionType<T>;
+    int rowsA = 0, colsA = 0, rowsB = 0, colsB = 0;
+    bool shapeMismatch = false;
+    auto shapeError = [&] {
+        cerr << "Error: " << filenameA << " is " << rowsA << "x" << colsA << " but " << filenameB
+             << " is " << rowsB << "x" << colsB << ", so they cannot be multiplied." << endl;
+        return 1;
+    };
+    auto rowView = [](const T* row, int cols) { return ConstMatrixView<T>(row, 1, cols, cols); };
+
+    if (is_floating_point<S>::value) cout << setprecision(17);
+
+    if (reduction == ProductReduction::Sum || reduction == ProductReduction::ColumnSums) {
+        // Column sums of A first; B is then streamed against them
+        vector<S> columnSumsA;
+        if (!streamMatrixFromFile<T>(filenameA, rowsA, colsA, [&](const T* row) {
+                accumulateColumnSums(rowView(row, colsA), columnSumsA);
+            })) return 1;
+
+        vector<S> rowSumsB, columnSumsC;
+        int row = 0;
+        if (!streamMatrixFromFile<T>(filenameB, rowsB, colsB, [&](const T* values) {
+                if (row >= colsA) {
+                    shapeMismatch = true;
+                } else if (reduction == ProductReduction::Sum) {
+                    accumulateRowSums(rowView(values, colsB), rowSumsB);
+                } else {
+                    accumulateProductColumnSums(rowView(values, colsB), row, columnSumsA, columnSumsC);
+                }
+                ++row;
+            })) return 1;
+        if (shapeMismatch || colsA != rowsB) return shapeError();
+
+        if (reduction == ProductReduction::Sum) cout << dotProduct(columnSumsA, rowSumsB);
+        else printValues(columnSumsC);
+        return 0;
     }
 
-    // Read the entire file content into a single string stream
-    stringstream buffer;
-    buffer << file.rdbuf();
-    string content = buffer.str();
-    
-    // --- Modified Parsing Logic: Replace C-style delimiters with spaces ---
-    for (char& c : content) {
-        // Replace all delimiters with a space for clean parsing
-        if (c == '{' || c == '}' || c == ',') {
-            c = ' ';
-        }
-    }
-    // --- End of Modified Parsing Logic ---
+    if (reduction == ProductReduction::RowSums) {
+        // Row sums of B first; A is then streamed against them
+        vector<S> rowSumsB;
+        if (!streamMatrixFromFile<T>(filenameB, rowsB, colsB, [&](const T* row) {
+                accumulateRowSums(rowView(row, colsB), rowSumsB);
+            })) return 1;
     
-    stringstream ss(content);
-    vector<int> all_elements;
-    int val;
+        vector<S> rowSumsC;
+        if (!streamMatrixFromFile<T>(filenameA, rowsA, colsA, [&](const T* row) {
+                if (colsA != rowsB) shapeMismatch = true;
+                else accumulateProductRowSums(rowView(row, colsA), rowSumsB, rowSumsC);
+            })) return 1;
+        if (shapeMismatch || colsA != rowsB) return shapeError();
     
-    // Extract all integers from the cleaned content
-    while (ss >> val) {
-        all_elements.push_back(val);
+        printValues(rowSumsC);
+        return 0;
     }
     
-    if (all_elements.empty()) {
-        cerr << "Error: Matrix in " << filename << " is empty or contains no valid numbers." << endl;
-        return {};
-    }
-    
-    size_t total_elements = all_elements.size();
-    int n = (int)round(sqrt(total_elements));
+    Matrix<T> matrixB = readMatrixFromFile<T>(filenameB);
+    if (matrixB.empty()) return 1;
+    rowsB = matrixB.rows;
+    colsB = matrixB.cols;
     
-    // Check if the total number of elements forms a perfect square matrix (n x n)
-    if ((size_t)n * n != total_elements) {
-        cerr << "Error: Matrix in " << filename << " has " << total_elements 
-             << " elements, which cannot form a square matrix (N x N)." << endl;
-        return {};
-    }
-    
-    // Reconstruct the square matrix
-    Matrix M(n, vector<int>(n));
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            M[i][j] = all_elements[i * n + j];
+    if (reduction == ProductReduction::Trace) {
+        S trace = S();
+        int row = 0;
+        if (!streamMatrixFromFile<T>(filenameA, rowsA, colsA, [&](const T* values) {
+                if (colsA != rowsB) shapeMismatch = true;
+                else if (row < colsB) trace = reductionAdd(trace, productTraceOfBand<T>(rowView(values, colsA), row, matrixB.view()));
+                ++row;
+            })) return 1;
+        if (shapeMismatch || colsA != rowsB) return shapeError();
+        if (rowsA != colsB) {
+            cerr << "Error: The product of " << filenameA << " and " << filenameB << " is " << rowsA << "x" << colsB
+                 << ", so it has no trace." << endl;
+            return 1;
         }
+        cout << trace;
+        return 0;
     }
     
-    return M;
+    if constexpr (is_arithmetic<T>::value) {
+        // Frobenius norm: rows of A are gathered into bands and each band of the product is formed and discarded
+        using R = ResultType<T>;
+        vector<R> widenedB, bandC, widenedA;
+        ConstMatrixView<R> wideB = copyAsResultType(ConstMatrixView<T>(matrixB.view()), widenedB);
+        matrixB = Matrix<T>();
+    
+        vector<T> band;
+        double squares = 0;
+        auto flush = [&] {
+            int bandRows = (int)(band.size() / max(colsA, 1));
+            if (bandRows > 0) {
+                squares += productSquaresOfBand(ConstMatrixView<T>(band.data(), bandRows, colsA, colsA), wideB, bandC, widenedA);
+            }
+            band.clear();
+        };
+        if (!streamMatrixFromFile<T>(filenameA, rowsA, colsA, [&](const T* row) {
+                if (colsA != rowsB) {
+                    shapeMismatch = true;
+                    return;
+                }
+                band.insert(band.end(), row, row + colsA);
+                if (band.size() >= (size_t)GEMM_MC * colsA) flush();
+            })) return 1;
+        if (shapeMismatch || colsA != rowsB) return shapeError();
+        flush();
+
+        cout << setprecision(17) << sqrt(squares);
+        return 0;
+    } else {
+        cerr << "Error: The Frobenius norm is not defined for modular element types." << endl;
+        return 1;
+    }
 }
-// --- Strassen's Helper Functions (Padding/Unpadding) ---
 
-/**
- * @brief Finds the smallest power of 2 greater than or equal to n.
- */
-int nextPowerOf2(int n) {
-    if (n <= 0) return 1;
-    if ((n & (n - 1)) == 0) return n; // Check if already power of 2
-    int power = 1;
-    while (power < n) power *= 2;
-    return power;
-}
+// --- Cutoff Calibration and Profile File ---
+
+// The best leaf size depends on the cache sizes, on the element type and on which SIMD kernel the
+// machine runs, so it is measured rather than guessed: 'strassen --calibrate' times the blocked
+// kernel against one level of recursion on growing sizes and stores the crossover in a small
+// profile file that later runs load automatically. Each element type has its own entries.
+const string DEFAULT_PROFILE_FILE = "strassen.profile";
 
 /**
- * @brief Pads a matrix with zeros up to a new size 'new_size'.
+ * @brief Calibrated cutoffs for each recursive variant, plus the kernel they were measured with.
  */
-Matrix padMatrix(const Matrix& M, int new_size) {
-    int old_size = M.size();
-    if (old_size == new_size) return M;
-    
-    Matrix padded_M(new_size, vector<int>(new_size, 0));
-    for (int i = 0; i < old_size; ++i) {
-        for (int j = 0; j < old_size; ++j) {
-            padded_M[i][j] = M[i][j];
-        }
+struct StrassenProfile {
+    int strassenCutoff = DEFAULT_STRASSEN_CUTOFF;
+    int winogradCutoff = DEFAULT_STRASSEN_CUTOFF;
+    string kernel;
+
+    int cutoffFor(MultiplyAlgorithm algorithm) const {
+        return algorithm == MultiplyAlgorithm::Winograd ? winogradCutoff : strassenCutoff;
+    }
+};
+
+//Fastest of 'repeats' runs of 'work', in seconds
+template <typename Work>
+double bestTime(Work work, int repeats) {
+    double best = 1e300;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = chrono::steady_clock::now();
+        work();
+        best = min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
     }
-    return padded_M;
+    return best;
 }
 
 /**
- * @brief Removes zero padding from a matrix, returning the original size.
+ * @brief Finds the cutoff for one variant and element type. For each candidate size n it compares
+ * the blocked kernel on n x n against a single level of recursion (with the kernel on the n/2 halves).
+ * The cutoff is the largest size at which the kernel still wins before recursion wins at two
+ * consecutive sizes; the second win guards against timer noise.
  */
-Matrix unpadMatrix(const Matrix& M, int original_size) {
-    Matrix unpadded_M(original_size, vector<int>(original_size));
-    for (int i = 0; i < original_size; ++i) {
-        for (int j = 0; j < original_size; ++j) {
-            unpadded_M[i][j] = M[i][j];
-        }
+template <typename T>
+int calibrateCutoff(MultiplyAlgorithm algorithm, ostream &log) {
+    const vector<int> sizes = {64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048};
+    mt19937 rng(2024);
+
+    int cutoff = sizes[0] / 2;
+    bool previousWon = false;
+    for (int n : sizes) {
+        Matrix<T> A(n, n), B(n, n), C(n, n);
+        for (T& x : A.data) x = T((long long)(rng() % 21) - 10);
+        for (T& x : B.data) x = T((long long)(rng() % 21) - 10);
+        StrassenWorkspace<T> workspace(strassenWorkspaceSize(n, n, n, n / 2));
+
+        int repeats = n <= 512 ? 5 : 3;
+        double kernelTime = bestTime([&] { blockedMultiply<T>(A.view(), B.view(), C.view()); }, repeats);
+        double recursiveTime = bestTime([&] {
+            serialMultiplyRecursive<T>(A.view(), B.view(), C.view(), workspace, algorithm, n / 2);
+        }, repeats);
+
+        bool recursionWins = recursiveTime < kernelTime;
+        log << "  n = " << n << ": kernel " << kernelTime * 1e3 << " ms, one level of recursion "
+            << recursiveTime * 1e3 << " ms" << (recursionWins ? " (recursion wins)" : "") << endl;
+
+        if (recursionWins && previousWon) return cutoff;
+        if (!recursionWins) cutoff = n;
+        previousWon = recursionWins;
     }
-    return unpadded_M;
+    return cutoff;
 }
 
-// --- Basic Matrix Operations ---
+//Measures both recursive variants for element type T on this machine
+template <typename T>
+StrassenProfile calibrateProfile(ostream &log) {
+    StrassenProfile profile;
+    profile.kernel = selectGemmKernel<T>().name;
+    log << "Calibrating Strassen cutoff (" << ElementTraits<T>::name() << ", " << profile.kernel << " kernel):" << endl;
+    profile.strassenCutoff = calibrateCutoff<T>(MultiplyAlgorithm::Strassen, log);
+    log << "Calibrating Winograd cutoff:" << endl;
+    profile.winogradCutoff = calibrateCutoff<T>(MultiplyAlgorithm::Winograd, log);
+    return profile;
+}
 
-//Function will multiply the matricies the brute force way where each row-column are multiplied and added
-Matrix bruteForce(const Matrix &matrixA, const Matrix &matrixB) {
-    int n = matrixA.size();
+/**
+ * @brief Writes the entries for one element type ("<type>.strassen_cutoff=..." and so on),
+ * keeping whatever the file already holds for the other types.
+ */
+bool saveProfile(const string &filename, const string &typeName, const StrassenProfile &profile) {
+    const string prefix = typeName + ".";
+    vector<string> kept;
+    ifstream existing(filename);
+    string line;
+    while (getline(existing, line)) {
+        if (line.empty() || line[0] == '#' || line.compare(0, prefix.size(), prefix) == 0) continue;
+        kept.push_back(line);
+    }
+    existing.close();
 
-    //Creates the resulting matrix with the appropriate size
-    Matrix matrixC(n, vector<int>(n, 0));
+    ofstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Error: Could not write profile file " << filename << "." << endl;
+        return false;
+    }
+    file << "# Strassen cutoff profile written by 'strassen --calibrate'" << endl;
+    file << "# Matrices with a dimension at or below the cutoff are multiplied with the blocked kernel" << endl;
+    for (const string& other : kept) file << other << endl;
+    file << prefix << "kernel=" << profile.kernel << endl;
+    file << prefix << "strassen_cutoff=" << profile.strassenCutoff << endl;
+    file << prefix << "winograd_cutoff=" << profile.winogradCutoff << endl;
+    return true;
+}
 
-    for(int i=0; i<n; ++i) {
-        for(int j=0; j<n; ++j) {
-            // Use long long for the intermediate sum to avoid overflow
-            long long sum = 0; 
-            for(int k=0; k<n; ++k) {
-                sum += (long long)matrixA[i][k] * matrixB[k][j];
+/**
+ * @brief Loads the entries for one element type written by saveProfile. Returns false (leaving
+ * 'profile' untouched) if the file does not exist, has no entries for the type, or was measured
+ * with a different SIMD kernel than 'kernel'.
+ */
+bool loadProfile(const string &filename, const string &typeName, const string &kernel, StrassenProfile &profile) {
+    ifstream file(filename);
+    if (!file.is_open()) return false;
+
+    const string prefix = typeName + ".";
+    StrassenProfile loaded;
+    bool found = false;
+    string line;
+    while (getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t equals = line.find('=');
+        if (equals == string::npos || line.compare(0, prefix.size(), prefix) != 0) continue;
+        string key = line.substr(prefix.size(), equals - prefix.size());
+        string value = line.substr(equals + 1);
+        found = true;
+        if (key == "kernel") {
+            loaded.kernel = value;
+        } else if (key == "strassen_cutoff" || key == "winograd_cutoff") {
+            int cutoff = 0;
+            if (parseNumber(value, cutoff)) {
+                (key == "strassen_cutoff" ? loaded.strassenCutoff : loaded.winogradCutoff) = max(1, cutoff);
+            } else {
+                cerr << "Warning: Ignoring malformed line '" << line << "' in " << filename << "." << endl;
             }
-            matrixC[i][j] = (int)sum;
         }
     }
+    if (!found) return false;
 
-    return matrixC;
+    if (loaded.kernel != kernel) {
+        cerr << "Warning: " << filename << " was calibrated for the " << loaded.kernel << " " << typeName
+             << " kernel but this machine uses " << kernel << "; run with --calibrate to refresh it." << endl;
+        return false;
+    }
+    profile = loaded;
+    return true;
 }
 
-//Function will take in two matrices and add them together. The resulting matrix is returned
-Matrix matrixAdd(const Matrix &matrixA, const Matrix &matrixB) {
-    int size = matrixA.size();
-    Matrix matrixC(size, vector<int>(size));
 
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            matrixC[i][j] = matrixA[i][j] + matrixB[i][j];
-        }
-    }
+// --- Utility and Main Function ---
 
-    return matrixC;
+/**
+ * @brief Calculates the sum of all entries in the matrix.
+ * @param m The input matrix (taken as const reference).
+ * @return The sum of all entries (int64 for integers, double for floating point, mod P for ModInt).
+ */
+template <typename T>
+typename ElementTraits<T>::Sum sumOfMatrixEntries(const Matrix<T> &m) {
+    typename ElementTraits<T>::Sum sum = typename ElementTraits<T>::Sum();
+    for(const T& value : m.data) {
+        sum += value;
+    }
+    return sum;
 }
 
-//Function will take in two matrices and subtract them. The resulting matrix is returned
-Matrix matrixSubtract(const Matrix &matrixA, const Matrix &matrixB) {
-    int size = matrixA.size();
-    Matrix matrixC(size, vector<int>(size));
-
-    for (int i = 0; i < size; ++i) {
-        for (int j = 0; j < size; ++j) {
-            matrixC[i][j] = matrixA[i][j] - matrixB[i][j];
+/**
+ * @brief Prints the matrix to the console.
+ */
+template <typename T>
+void printMatrix(const Matrix<T>& M, const string& name) {
+    cout << name << " Matrix (" << M.rows << "x" << M.cols << "):" << endl;
+    for (int i = 0; i < M.rows; ++i) {
+        for (int j = 0; j < M.cols; ++j) {
+            cout << M[i][j] << "\t";
         }
+        cout << "\n";
     }
+}
 
-    return matrixC;
+/**
+ * @brief Converts a text matrix file to the binary format, which later runs load without parsing.
+ * ModInt matrices are stored as their int64 residues. Returns the process exit code.
+ */
+template <typename T>
+int convertToBinary(const string &input, const string &output) {
+    Matrix<T> M = readMatrixFromFile<T>(input);
+    if (M.empty()) return 1;
+    bool written;
+    if constexpr (is_arithmetic<T>::value) {
+        written = writeBinaryArray(output, {(uint64_t)M.rows, (uint64_t)M.cols}, M.data.data());
+    } else {
+        vector<int64_t> residues(M.data.size());
+        for (size_t i = 0; i < M.data.size(); ++i) residues[i] = M.data[i].value;
+        written = writeBinaryArray(output, {(uint64_t)M.rows, (uint64_t)M.cols}, residues.data());
+    }
+    if (!written) {
+        cerr << "Error: Could not write " << output << endl;
+        return 1;
+    }
+    return 0;
 }
 
-//Function splits input matrixM into 4 sub-matrices and stores it into the second parameter result
-void split(const Matrix &matrixM, vector<Matrix> &result) {
-    int size = matrixM.size();
-    
-    // Check for even size, required for split
-    if (size % 2 != 0) {
-        throw runtime_error("Error: Split called on non-even matrix size. Padding error occurred.");
+/**
+ * @brief Calibrates, or reads both files as element type T and prints the requested reduction of
+ * their product, or (with 'toBinary') converts filenameA to a binary file named filenameB.
+ * Unless 'fullProduct' is set the reduction is fused (see reduceProductFromFiles);
+ * otherwise the whole product is formed with 'options' and its entries are summed.
+ * Returns the process exit code.
+ */
+template <typename T>
+int runMultiply(const string &filenameA, const string &filenameB, StrassenOptions options,
+                const string &profileFile, bool calibrate, ProductReduction reduction, bool fullProduct, bool toBinary) {
+    using Compute = ResultType<T>;
+    const string typeName = ElementTraits<Compute>::name();
+
+    if (toBinary) return convertToBinary<T>(filenameA, filenameB);
+
+    if (calibrate) {
+        StrassenProfile profile = calibrateProfile<Compute>(cout);
+        if (!saveProfile(profileFile, typeName, profile)) return 1;
+        cout << "Saved " << typeName << " cutoffs (Strassen " << profile.strassenCutoff << ", Winograd "
+             << profile.winogradCutoff << ") to " << profileFile << endl;
+        return 0;
     }
-    
-    int halfSize = size / 2;
 
-    result.resize(4);
-    for (int i = 0; i < 4; ++i) {
-        result[i].assign(halfSize, vector<int>(halfSize));
+    if (!fullProduct) {
+        return reduceProductFromFiles<T>(reduction, filenameA, filenameB);
     }
 
-    const int A11 = 0, A12 = 1, A21 = 2, A22 = 3;
-
-    for (int i = 0; i < halfSize; ++i) {
-        for (int j = 0; j < halfSize; ++j) {
-            // A11 (Top-Left)
-            result[A11][i][j] = matrixM[i][j];
-            // A12 (Top-Right)
-            result[A12][i][j] = matrixM[i][j + halfSize];
-            // A21 (Bottom-Left)
-            result[A21][i][j] = matrixM[i + halfSize][j];
-            // A22 (Bottom-Right)
-            result[A22][i][j] = matrixM[i + halfSize][j + halfSize];
-        }
+    // An explicit --cutoff wins; otherwise use the calibrated value if this machine has a profile
+    if (options.cutoff == 0) {
+        StrassenProfile profile;
+        loadProfile(profileFile, typeName, selectGemmKernel<Compute>().name, profile);
+        options.cutoff = profile.cutoffFor(options.algorithm);
     }
-}
 
-//Function joins back four sub-matricies that are inputted
-Matrix join(const Matrix &C11, const Matrix &C12, const Matrix &C21, const Matrix &C22) {
-    int halfSize = C11.size();
-    int size = halfSize * 2;
-    Matrix matrixC(size, vector<int>(size));
-
-    for (int i = 0; i < halfSize; ++i) {
-        for (int j = 0; j < halfSize; ++j) {
-            matrixC[i][j] = C11[i][j];
-            matrixC[i][j + halfSize] = C12[i][j];
-            matrixC[i + halfSize][j] = C21[i][j];
-            matrixC[i + halfSize][j + halfSize] = C22[i][j];
-        }
+    Matrix<T> matrixA = readMatrixFromFile<T>(filenameA);
+    Matrix<T> matrixB = readMatrixFromFile<T>(filenameB);
+    if (matrixA.empty() || matrixB.empty()) {
+        return 1; // The reader has already explained what went wrong
     }
-    
-    return matrixC;
+    if (matrixA.cols != matrixB.rows) {
+        cerr << "Error: " << filenameA << " is " << matrixA.rows << "x" << matrixA.cols << " but " << filenameB
+             << " is " << matrixB.rows << "x" << matrixB.cols << ", so they cannot be multiplied." << endl;
+        return 1;
+    }
+    Matrix<Compute> matrixC = strassenMultiply(matrixA, matrixB, options);
+    auto answer = sumOfMatrixEntries(matrixC);
+
+    if (is_floating_point<Compute>::value) cout << setprecision(17);
+    cout << answer;
+    return 0;
 }
 
-// --- Strassen's Recursive Core ---
+// --- Out-of-Core Mode ---
 
-//Multiplies 2 matrices using Strassen's Algorithm - This is the recursive part
-Matrix strassenMultiplyRecursive(const Matrix &matrixA, const Matrix &matrixB) {
-    int n = matrixA.size();
+// Memory the out-of-core working set may use unless --memory-budget says otherwise
+const size_t DEFAULT_MEMORY_BUDGET_MB = 1024;
 
-    // Base Case: Switch to standard brute force multiplication for small matrices
-    if (n <= 32) { // Use a reasonable cutoff for efficiency
-        return bruteForce(matrixA, matrixB);
+/**
+ * @brief Converts a text or binary matrix file into a tiled file (see outOfCore.h). The input is
+ * streamed twice - once for its shape, once to fill the tiles - so it never has to fit in memory.
+ * A tile larger than the matrix is shrunk to it (see clampTileToShape).
+ * Returns the process exit code.
+ */
+template <typename T>
+int convertToTiled(const string &input, const string &output, int tile) {
+    int rows, cols;
+    if (!streamMatrixFromFile<T>(input, rows, cols, [](const T*) {})) return 1;
+    tile = clampTileToShape(tile, rows, cols);
+
+    TiledMatrixFile<T> tiled;
+    string error;
+    if (!tiled.create(output, rows, cols, tile, error)) {
+        cerr << "Error: " << error << endl;
+        return 1;
     }
-
-    // Split matrices matrixA and matrixB into four n/2 x n/2 submatrices
-    vector<Matrix> A_parts(4), B_parts(4);
-    split(matrixA, A_parts);
-    split(matrixB, B_parts);
-
-    const Matrix& A11 = A_parts[0];
-    const Matrix& A12 = A_parts[1];
-    const Matrix& A21 = A_parts[2];
-    const Matrix& A22 = A_parts[3];
-
-    const Matrix& B11 = B_parts[0];
-    const Matrix& B12 = B_parts[1];
-    const Matrix& B21 = B_parts[2];
-    const Matrix& B22 = B_parts[3];
-
-    // 10 intermediate matrices (S1 to S10)
-    Matrix S1 = matrixSubtract(B12, B22);
-    Matrix S2 = matrixAdd(A11, A12);
-    Matrix S3 = matrixAdd(A21, A22);
-    Matrix S4 = matrixSubtract(B21, B11);
-    Matrix S5 = matrixAdd(A11, A22);
-    Matrix S6 = matrixAdd(B11, B22);
-    Matrix S7 = matrixSubtract(A12, A22);
-    Matrix S8 = matrixAdd(B21, B22);
-    Matrix S9 = matrixSubtract(A11, A21);
-    Matrix S10 = matrixAdd(B11, B12);
-
-    // 7 recursive calls to matrix multiplication (P1 to P7):
-    Matrix P1 = strassenMultiplyRecursive(A11, S1);
-    Matrix P2 = strassenMultiplyRecursive(S2, B22);
-    Matrix P3 = strassenMultiplyRecursive(S3, B11);
-    Matrix P4 = strassenMultiplyRecursive(A22, S4);
-    Matrix P5 = strassenMultiplyRecursive(S5, S6);
-    Matrix P6 = strassenMultiplyRecursive(S7, S8);
-    Matrix P7 = strassenMultiplyRecursive(S9, S10);
-
-    // Combining the products to get the four result quadrants (C11, C12, C21, C22):
-
-    // C11 = P5 + P4 - P2 + P6
-    Matrix C11 = matrixAdd(matrixSubtract(matrixAdd(P5, P4), P2), P6);
-
-    // C12 = P1 + P2
-    Matrix C12 = matrixAdd(P1, P2);
-
-    // C21 = P3 + P4
-    Matrix C21 = matrixAdd(P3, P4);
-
-    // C22 = P5 + P1 - P3 - P7
-    Matrix C22 = matrixSubtract(matrixSubtract(matrixAdd(P5, P1), P3), P7);
-
-    // Join the four quadrants into the final result matrixC
-    return join(C11, C12, C21, C22);
+    int row = 0;
+    bool ok = streamMatrixFromFile<T>(input, rows, cols, [&](const T* values) {
+        int i = row / tile, r = row % tile;
+        for (int j = 0; j < tiled.tileCols(); ++j) {
+            int width = min(tile, cols - j * tile);
+            copy(values + (size_t)j * tile, values + (size_t)j * tile + width, tiled.tileView(i, j)[r]);
+        }
+        // A finished strip of tiles is written back and leaves memory
+        if (r == tile - 1 || row == rows - 1) {
+            for (int j = 0; j < tiled.tileCols(); ++j) {
+                tiled.flush(i, j);
+                tiled.evict(i, j);
+            }
+        }
+        ++row;
+    });
+    if (!ok) return 1;
+    cout << "Wrote " << rows << "x" << cols << " matrix in " << tile << "x" << tile << " tiles to " << output << endl;
+    return 0;
 }
 
-// --- Strassen's Top-Level Function with Padding ---
-
 /**
- * @brief Top-level function that handles padding before calling the recursive Strassen's core.
+ * @brief --to-tiled converts files[0] into the tiled file files[1]; --out-of-core multiplies the
+ * tiled files files[0] and files[1] into the tiled file files[2] and prints the sum of its entries.
+ * Returns the process exit code.
  */
-Matrix strassenMultiply(const Matrix &matrixA, const Matrix &matrixB) {
-    int n = matrixA.size();
-    
-    // 1. Determine the necessary size (next power of 2)
-    int target_size = nextPowerOf2(n);
-    
-    // 2. Pad the matrices to the target size
-    Matrix paddedA = padMatrix(matrixA, target_size);
-    Matrix paddedB = padMatrix(matrixB, target_size);
+template <typename T>
+int runOutOfCore(const vector<string> &files, const StrassenOptions &options, size_t budgetBytes, int tile, bool toTiled) {
+    if constexpr (!is_arithmetic<T>::value) {
+        cerr << "Error: Out-of-core files hold int32, int64, float or double elements." << endl;
+        return 1;
+    } else {
+        using Compute = ResultType<T>;
+        int budgetTile = tileSizeForBudget<T>(budgetBytes, options);
+        if (toTiled) {
+            if (tile > 0 && tile % TILE_GRANULARITY != 0) {
+                cerr << "Error: --tile must be a multiple of " << TILE_GRANULARITY << "." << endl;
+                return 1;
+            }
+            return convertToTiled<T>(files[0], files[1], tile > 0 ? tile : budgetTile);
+        }
 
-    // 3. Perform recursive Strassen's multiplication
-    Matrix paddedC = strassenMultiplyRecursive(paddedA, paddedB);
+        TiledMatrixFile<T> matrixA, matrixB;
+        TiledMatrixFile<Compute> matrixC;
+        string error;
+        if (!matrixA.open(files[0], error) || !matrixB.open(files[1], error) ||
+            !matrixC.create(files[2], matrixA.rows(), matrixB.cols(), matrixA.tile(), error)) {
+            cerr << "Error: " << error << endl;
+            return 1;
+        }
+        if (tiledWorkingSetBytes<T>(matrixA.tile(), options) > budgetBytes) {
+            cerr << "Warning: " << matrixA.tile() << "x" << matrixA.tile() << " tiles need more memory than the budget; "
+                 << "re-tile the inputs with --tile " << budgetTile << " to stay within it." << endl;
+        }
+        try {
+            multiplyTiled(matrixA, matrixB, matrixC, options);
+        } catch (const runtime_error &e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
 
-    // 4. Unpad the result to get the matrix of the original size (n x n)
-    return unpadMatrix(paddedC, n);
+        if (is_floating_point<Compute>::value) cout << setprecision(17);
+        cout << tiledMatrixSum(matrixC);
+        return 0;
+    }
 }
 
-
-// --- Utility and Main Function ---
+// --- Batches of Small Products ---
 
 /**
- * @brief Calculates the sum of all entries in the matrix.
- * @param m The input matrix (taken as const reference).
- * @return The sum of all entries (using long long for safety).
+ * @brief --batch multiplies 'count' random pairs of n x n matrices with batchedMultiply, prints the
+ * time it took and checks every product against the blocked kernel. Returns the process exit code.
  */
-long long sumOfMatrixEntries(const Matrix &m) {
-    long long sum = 0;
-    for(size_t i=0; i<m.size(); i++) {
-        for(size_t j=0; j<m[i].size(); j++) {
-            sum += m[i][j];
+template <typename T>
+int runBatch(int n, size_t count, unsigned threads) {
+    using R = ResultType<T>;
+    const size_t area = (size_t)n * n;
+    mt19937 rng(2024);
+    vector<T> pairs(2 * count * area);
+    for (T& x : pairs) x = T((long long)(rng() % 21) - 10);
+    vector<R> products(count * area);
+
+    auto start = chrono::steady_clock::now();
+    batchedMultiply(pairs.data(), products.data(), n, count, threads);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Multiplied " << count << " pairs of " << n << "x" << n << " matrices in " << seconds * 1e3 << " ms" << endl;
+
+    // Entries stay small integers, so every type, floating point included, must match exactly
+    vector<R> widenedA, widenedB, expected(area);
+    for (size_t b = 0; b < count; ++b) {
+        ConstMatrixView<T> A(pairs.data() + 2 * b * area, n, n, n), B(pairs.data() + (2 * b + 1) * area, n, n, n);
+        blockedMultiply<R>(copyAsResultType<R>(A, widenedA), copyAsResultType<R>(B, widenedB), MatrixView<R>{expected.data(), n, n, n});
+        if (!equal(expected.begin(), expected.end(), products.begin() + b * area)) {
+            cerr << "Error: Product " << b << " of the batch differs from the blocked kernel." << endl;
+            return 1;
         }
     }
-    return sum;
+    cout << "Verification successful." << endl;
+    return 0;
 }
 
-/**
- * @brief Prints the matrix to the console.
- */
-void printMatrix(const Matrix& M, const string& name) {
-    cout << name << " Matrix (" << M.size() << "x" << M.size() << "):" << endl;
-    for (const auto& row : M) {
-        for (int val : row) {
-            cout << val << "\t";
-        }
-        cout << "\n";
-    }
+// Stands in for an element type when main picks the instantiation at runtime
+template <typename T>
+struct ElementTag {
+    using type = T;
+};
+
+//Calls run(ElementTag<T>()) for the element type named 'typeName'
+template <typename Run>
+int dispatchElementType(const string &typeName, Run run) {
+    // Each element type is a separate instantiation of the engine with its own kernels
+    if (typeName == "int32") return run(ElementTag<int32_t>());
+    if (typeName == "int64") return run(ElementTag<int64_t>());
+    if (typeName == "float") return run(ElementTag<float>());
+    if (typeName == "double") return run(ElementTag<double>());
+    if (typeName == "mod998244353") return run(ElementTag<ModInt<998244353>>());
+    if (typeName == "mod1000000007") return run(ElementTag<ModInt<1000000007>>());
+    cerr << "Error: Unknown element type '" << typeName << "'. Use int32, int64, float, double, mod998244353 or mod1000000007." << endl;
+    return 1;
 }
 
 //Gives an example usage using the two text files exampleMatrix1 and exampleMatrix2
-int main() {
+//Usage: strassen [--reduce R] [--type T] [fileA fileB]
+//       strassen --full-product [--classic | --winograd] [--cutoff N] [--threads N] [--parallel-depth D] [--profile FILE] [--type T] [fileA fileB]
+//       strassen --calibrate [--profile FILE] [--type T]
+//       strassen --to-binary [--type T] input output
+//       strassen --to-tiled [--tile N | --memory-budget MB [--threads N]] [--type T] input output
+//       strassen --out-of-core [--memory-budget MB] [--classic | --winograd] [--cutoff N] [--threads N] [--type T] tiledA tiledB tiledC
+//       strassen --batch N COUNT [--threads N] [--type T]
+//By default the sum of the product's entries is computed from the files without forming the product;
+//--reduce picks another reduction: sum, trace, rowsums, colsums or frobenius.
+//--full-product (implied by --classic and --winograd) forms the whole product and sums it instead.
+//Either input may be a binary matrix written by --to-binary, which loads without parsing.
+//--out-of-core multiplies matrices too large for memory from tiled files written by --to-tiled, keeping
+//only a few tiles resident (the tile size follows from --memory-budget, 1024 MB by default, and from
+//--threads, since the parallel recursion needs more scratch than the serial one, and never exceeds the
+//matrix itself; operands with different shapes may need the same explicit --tile).
+//--batch multiplies COUNT random pairs of N x N matrices as one batch and checks them against the blocked kernel.
+//Element types T: int32 (default, exact 64-bit results), int64, float, double, mod998244353, mod1000000007
+//Build with -pthread, e.g. g++ -O2 -std=c++17 -pthread strassen.cpp -o strassen
+int main(int argc, char* argv[]) {
 
     // Define the filenames for input as specified in your last request
-    const string filenameA = "exampleMatrix1.txt";
-    const string filenameB = "exampleMatrix2.txt";
-
-    Matrix matrixA = readMatrixFromFile(filenameA);
-    Matrix matrixB = readMatrixFromFile(filenameB);
-    Matrix matrixC = strassenMultiply(matrixA, matrixB);
-    int answer = sumOfMatrixEntries(matrixC);
+    string filenameA = "exampleMatrix1.txt";
+    string filenameB = "exampleMatrix2.txt";
+    StrassenOptions options;
+    string profileFile = DEFAULT_PROFILE_FILE;
+    string typeName = "int32";
+    ProductReduction reduction = ProductReduction::Sum;
+    bool fullProduct = false;
+    bool calibrate = false;
+    bool toBinary = false;
+    bool toTiled = false;
+    bool outOfCore = false;
+    size_t memoryBudgetMB = DEFAULT_MEMORY_BUDGET_MB;
+    int tile = 0;
+    int batchSize = 0;
+    size_t batchCount = 0;
+
+    vector<string> files;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--classic") {
+            options.algorithm = MultiplyAlgorithm::Classic;
+            fullProduct = true;
+        } else if (arg == "--winograd") {
+            options.algorithm = MultiplyAlgorithm::Winograd;
+            fullProduct = true;
+        } else if (arg == "--full-product") {
+            fullProduct = true;
+        } else if (arg == "--reduce" && i + 1 < argc) {
+            if (!parseReduction(argv[++i], reduction)) {
+                cerr << "Error: Unknown reduction '" << argv[i] << "'. Use sum, trace, rowsums, colsums or frobenius." << endl;
+                return 1;
+            }
+        } else if (arg == "--cutoff" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], options.cutoff)) return badFlagValue(arg, argv[i]);
+            options.cutoff = max(1, options.cutoff);
+        } else if (arg == "--calibrate") {
+            calibrate = true;
+        } else if (arg == "--to-binary") {
+            toBinary = true;
+        } else if (arg == "--to-tiled") {
+            toTiled = true;
+        } else if (arg == "--out-of-core") {
+            outOfCore = true;
+        } else if (arg == "--memory-budget" && i + 1 < argc) {
+            int megabytes = 0;
+            if (!parseNumber(argv[++i], megabytes)) return badFlagValue(arg, argv[i]);
+            memoryBudgetMB = (size_t)max(1, megabytes);
+        } else if (arg == "--tile" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], tile)) return badFlagValue(arg, argv[i]);
+            tile = max(1, tile);
+        } else if (arg == "--profile" && i + 1 < argc) {
+            profileFile = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            int threads = 0;
+            if (!parseNumber(argv[++i], threads)) return badFlagValue(arg, argv[i]);
+            options.threads = max(1, threads);
+        } else if (arg == "--parallel-depth" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], options.parallelDepth)) return badFlagValue(arg, argv[i]);
+        } else if (arg == "--type" && i + 1 < argc) {
+            typeName = argv[++i];
+        } else if (arg == "--batch" && i + 2 < argc) {
+            int count = 0;
+            if (!parseNumber(argv[++i], batchSize)) return badFlagValue(arg, argv[i]);
+            if (!parseNumber(argv[++i], count)) return badFlagValue(arg, argv[i]);
+            batchSize = max(1, batchSize);
+            batchCount = (size_t)max(1, count);
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (batchSize > 0) {
+        if (!files.empty()) {
+            cerr << "Usage: " << argv[0] << " --batch N COUNT [--threads N] [--type T]" << endl;
+            return 1;
+        }
+        return dispatchElementType(typeName, [&](auto element) {
+            using T = typename decltype(element)::type;
+            return runBatch<T>(batchSize, batchCount, options.threads);
+        });
+    }
+    if (outOfCore || toTiled) {
+        if (files.size() != (outOfCore ? 3u : 2u)) {
+            cerr << "Usage: " << argv[0] << (outOfCore ? " --out-of-core [options] tiledA tiledB tiledC" : " --to-tiled [options] input output")
+                 << endl;
+            return 1;
+        }
+        return dispatchElementType(typeName, [&](auto element) {
+            using T = typename decltype(element)::type;
+            return runOutOfCore<T>(files, options, memoryBudgetMB << 20, tile, toTiled);
+        });
+    }
+    if (files.size() == 2) {
+        filenameA = files[0];
+        filenameB = files[1];
+    } else if (!files.empty() || toBinary) {
+        cerr << "Usage: " << argv[0] << " [--reduce R | --full-product] [--classic | --winograd] [--cutoff N] [--threads N]"
+             << " [--parallel-depth D] [--profile FILE] [--type T] [fileA fileB]" << endl;
+        return 1;
+    }
+    if (fullProduct && reduction != ProductReduction::Sum) {
+        cerr << "Error: --full-product only prints the sum; leave it out to use --reduce." << endl;
+        return 1;
+    }
 
-    cout << answer;
+    return dispatchElementType(typeName, [&](auto element) {
+        using T = typename decltype(element)::type;
+        return runMultiply<T>(filenameA, filenameB, options, profileFile, calibrate, reduction, fullProduct, toBinary);
+    });
 
 }
 
@@ -0,0 +1,706 @@
+/**
+ * Strassen's algorithm (and Winograd's variant) for m x k by k x n matrices of any element type
+ * in matrix.h, serial or on a work-stealing thread pool.
+ *
+ * The engine itself runs on the "compute" types int64_t, float, double and ModInt<P>. int32_t
+ * inputs are widened to int64_t once on the way in (an O(n^2) copy), so the seven products and
+ * the operand sums of every level are exact instead of wrapping at 32 bits.
+*/
+
+#ifndef STRASSEN_STRASSEN_H
+#define STRASSEN_STRASSEN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../../Common/threadPool.h"
+#include "gemmKernels.h"
+#include "matrix.h"
+
+// --- Basic Matrix Operations ---
+
+//Function will add two matrices together, writing the result into matrixC (matrixC = matrixA + matrixB)
+template <typename T>
+void matrixAddInto(ConstMatrixView<T> matrixA, ConstMatrixView<T> matrixB, MatrixView<T> matrixC) {
+    for (int i = 0; i < matrixC.rows; ++i) {
+        const T* a = matrixA[i];
+        const T* b = matrixB[i];
+        T* c = matrixC[i];
+        for (int j = 0; j < matrixC.cols; ++j) {
+            c[j] = a[j] + b[j];
+        }
+    }
+}
+
+//Function will subtract two matrices, writing the result into matrixC (matrixC = matrixA - matrixB)
+template <typename T>
+void matrixSubtractInto(ConstMatrixView<T> matrixA, ConstMatrixView<T> matrixB, MatrixView<T> matrixC) {
+    for (int i = 0; i < matrixC.rows; ++i) {
+        const T* a = matrixA[i];
+        const T* b = matrixB[i];
+        T* c = matrixC[i];
+        for (int j = 0; j < matrixC.cols; ++j) {
+            c[j] = a[j] - b[j];
+        }
+    }
+}
+
+//Function adds matrixA onto matrixC in place (matrixC += matrixA)
+template <typename T>
+void matrixAccumulate(MatrixView<T> matrixC, ConstMatrixView<T> matrixA) {
+    matrixAddInto<T>(matrixC, matrixA, matrixC);
+}
+
+//Function subtracts matrixA from matrixC in place (matrixC -= matrixA)
+template <typename T>
+void matrixDeduct(MatrixView<T> matrixC, ConstMatrixView<T> matrixA) {
+    matrixSubtractInto<T>(matrixC, matrixA, matrixC);
+}
+
+//Function copies matrixA into matrixC, negating every entry when 'negate' is set
+template <typename T>
+void matrixCopy(ConstMatrixView<T> matrixA, MatrixView<T> matrixC, bool negate = false) {
+    for (int i = 0; i < matrixC.rows; ++i) {
+        const T* a = matrixA[i];
+        T* c = matrixC[i];
+        for (int j = 0; j < matrixC.cols; ++j) {
+            c[j] = negate ? -a[j] : a[j];
+        }
+    }
+}
+
+// --- Configuration ---
+
+// Algorithms strassenMultiply can run
+enum class MultiplyAlgorithm {
+    Strassen, // Strassen's recursion (7 products, 18 additions per level) with the blocked kernel at the leaves
+    Winograd, // Winograd's variant of Strassen's recursion (7 products, 15 additions per level)
+    Classic   // The blocked kernel on the whole matrix (plain O(n^3) GEMM)
+};
+
+// Leaf size used when neither the caller nor a calibration profile provides one
+const int DEFAULT_STRASSEN_CUTOFF = 256;
+
+/**
+ * @brief Tuning knobs for strassenMultiply.
+ */
+struct StrassenOptions {
+    MultiplyAlgorithm algorithm = MultiplyAlgorithm::Strassen;
+    int cutoff = 0;         // Matrices with a dimension at or below this are multiplied directly; 0 uses the default
+    unsigned threads = 1;   // Threads to use; 1 keeps the whole multiply on the calling thread
+    int parallelDepth = -1; // Recursion levels that fan out into tasks; -1 picks enough to keep every thread busy
+};
+
+// --- Workspace Arena for Strassen's Temporaries ---
+
+/**
+ * @brief Stack-style arena holding every temporary the recursion needs. It is sized once
+ * before the multiply starts; each recursion level takes its scratch blocks from the top
+ * and hands them back on return, so the recursion itself never calls the allocator.
+ * A workspace can also be a non-owning slice of a parent arena (see carve()), which is how
+ * concurrently running products each get private scratch space.
+ */
+template <typename T>
+class StrassenWorkspace {
+public:
+    StrassenWorkspace() = default;
+    explicit StrassenWorkspace(size_t elements) { reserve(elements); }
+    StrassenWorkspace(T* memory, size_t elements) : base(memory), capacity(elements) {}
+
+    StrassenWorkspace(const StrassenWorkspace&) = delete;
+    StrassenWorkspace& operator=(const StrassenWorkspace&) = delete;
+    StrassenWorkspace(StrassenWorkspace&&) = default;
+    StrassenWorkspace& operator=(StrassenWorkspace&&) = default;
+
+    //Grows the arena to at least 'elements' entries. Only valid while nothing is allocated.
+    void reserve(size_t elements) {
+        if (capacity < elements) {
+            storage.resize(elements);
+            base = storage.data();
+            capacity = elements;
+        }
+    }
+
+    //Hands out an uninitialised rows x cols block from the top of the arena
+    MatrixView<T> allocate(int rows, int cols) {
+        return {allocateRaw((size_t)rows * cols), rows, cols, cols};
+    }
+
+    //Splits off the next 'elements' entries as an independent workspace
+    StrassenWorkspace carve(size_t elements) {
+        return StrassenWorkspace(allocateRaw(elements), elements);
+    }
+
+    //mark() and release() bracket one recursion level: everything allocated after mark() is freed by release()
+    size_t mark() const { return top; }
+    void release(size_t marker) { top = marker; }
+
+private:
+    T* allocateRaw(size_t elements) {
+        if (top + elements > capacity) {
+            throw std::runtime_error("Error: Strassen workspace exhausted. It was sized for a smaller matrix.");
+        }
+        T* block = base + top;
+        top += elements;
+        return block;
+    }
+
+    std::vector<T> storage;
+    T* base = nullptr;
+    size_t capacity = 0;
+    size_t top = 0;
+};
+
+/**
+ * @brief Number of workspace elements needed to multiply an m x k matrix by a k x n matrix
+ * with either serial recursion (both variants use the same scratch blocks).
+ * Every level above the cutoff holds one A-shaped, one B-shaped and one C-shaped half-size
+ * block while it recurses; for square inputs that is 3 * ((n/2)^2 + (n/4)^2 + ...) < n^2.
+ */
+inline size_t strassenWorkspaceSize(int m, int k, int n, int cutoff) {
+    size_t total = 0;
+    while (std::min({m, k, n}) > cutoff) {
+        size_t halfM = m / 2, halfK = k / 2, halfN = n / 2;
+        total += halfM * halfK + halfK * halfN + halfM * halfN;
+        m /= 2;
+        k /= 2;
+        n /= 2;
+    }
+    return total;
+}
+
+// --- Dynamic Peeling for Odd Dimensions ---
+
+// Instead of padding to a power of two, each level runs Strassen on the even-sized leading
+// block (m2 x k2 times k2 x n2, with m2 = m rounded down to even and so on) and then patches
+// in what an odd dimension leaves over with thin kernel calls:
+//   PEEL_INNER:  C[0:m2, 0:n2] += A[0:m2, k-1] * B[k-1, 0:n2]   (rank-1 update, needs the core first)
+//   PEEL_COLUMN: C[0:m2, n-1]   = A[0:m2, :]   * B[:, n-1]      (matrix-vector)
+//   PEEL_ROW:    C[m-1, :]      = A[m-1, :]    * B              (vector-matrix)
+// The column and row fix-ups touch parts of C the core never writes.
+enum PeelPart { PEEL_INNER, PEEL_COLUMN, PEEL_ROW };
+
+template <typename T>
+void applyPeeling(ConstMatrixView<T> matrixA, ConstMatrixView<T> matrixB, MatrixView<T> matrixC, PeelPart part) {
+    int m = matrixC.rows, n = matrixC.cols, k = matrixA.cols;
+    int m2 = m & ~1, n2 = n & ~1, k2 = k & ~1;
+
+    if (part == PEEL_INNER && k2 != k) {
+        blockedMultiply<T>(matrixA.block(0, k2, m2, 1), matrixB.block(k2, 0, 1, n2), matrixC.block(0, 0, m2, n2), true);
+    } else if (part == PEEL_COLUMN && n2 != n) {
+        blockedMultiply<T>(matrixA.block(0, 0, m2, k), matrixB.block(0, n2, k, 1), matrixC.block(0, n2, m2, 1));
+    } else if (part == PEEL_ROW && m2 != m) {
+        blockedMultiply<T>(matrixA.block(m2, 0, 1, k), matrixB, matrixC.block(m2, 0, 1, n));
+    }
+}
+
+// --- Strassen's Recursive Core ---
+
+//Multiplies 2 matrices using Strassen's Algorithm - This is the recursive part
+//The operands and the result are views, so the quadrants are addressed in place instead of being split/joined.
+//A is m x k and B is k x n for any sizes; odd dimensions are handled by dynamic peeling (see above).
+//All temporaries come from 'workspace': X and Y hold the A-side and B-side operand sums and P holds one
+//product at a time, which is folded into the result quadrants straight away with the in-place helpers.
+template <typename T>
+void strassenMultiplyRecursive(ConstMatrixView<T> matrixA, ConstMatrixView<T> matrixB, MatrixView<T> matrixC,
+                               StrassenWorkspace<T> &workspace, int cutoff) {
+    int m = matrixC.rows, n = matrixC.cols, k = matrixA.cols;
+
+    // Base Case: Switch to the blocked kernel once any dimension is small
+    if (std::min({m, k, n}) <= cutoff) {
+        blockedMultiply(matrixA, matrixB, matrixC);
+        return;
+    }
+
+    int halfM = m / 2, halfK = k / 2, halfN = n / 2;
+
+    // View the even-sized leading blocks of matrixA, matrixB and matrixC as four submatrices each
+    ConstMatrixView<T> evenA = matrixA.block(0, 0, 2 * halfM, 2 * halfK);
+    ConstMatrixView<T> evenB = matrixB.block(0, 0, 2 * halfK, 2 * halfN);
+    MatrixView<T> evenC = matrixC.block(0, 0, 2 * halfM, 2 * halfN);
+
+    ConstMatrixView<T> A11 = evenA.quadrant(0);
+    ConstMatrixView<T> A12 = evenA.quadrant(1);
+    ConstMatrixView<T> A21 = evenA.quadrant(2);
+    ConstMatrixView<T> A22 = evenA.quadrant(3);
+
+    ConstMatrixView<T> B11 = evenB.quadrant(0);
+    ConstMatrixView<T> B12 = evenB.quadrant(1);
+    ConstMatrixView<T> B21 = evenB.quadrant(2);
+    ConstMatrixView<T> B22 = evenB.quadrant(3);
+
+    MatrixView<T> C11 = evenC.quadrant(0);
+    MatrixView<T> C12 = evenC.quadrant(1);
+    MatrixView<T> C21 = evenC.quadrant(2);
+    MatrixView<T> C22 = evenC.quadrant(3);
+
+    // Scratch blocks for this level, returned to the arena before leaving
+    size_t marker = workspace.mark();
+    MatrixView<T> X = workspace.allocate(halfM, halfK);
+    MatrixView<T> Y = workspace.allocate(halfK, halfN);
+    MatrixView<T> P = workspace.allocate(halfM, halfN);
+
+    // The 7 products are formed one after another from the 10 sums (S1 to S10):
+    //   C11 = P5 + P4 - P2 + P6    C12 = P1 + P2
+    //   C21 = P3 + P4              C22 = P5 + P1 - P3 - P7
+
+    // P1 = A11 * (B12 - B22), written straight into C12 and copied to C22
+    matrixSubtractInto<T>(B12, B22, Y);
+    strassenMultiplyRecursive<T>(A11, Y, C12, workspace, cutoff);
+    matrixCopy<T>(C12, C22);
+
+    // P2 = (A11 + A12) * B22
+    matrixAddInto<T>(A11, A12, X);
+    strassenMultiplyRecursive<T>(X, B22, P, workspace, cutoff);
+    matrixAccumulate<T>(C12, P);
+    matrixCopy<T>(P, C11, true);
+
+    // P3 = (A21 + A22) * B11, written straight into C21
+    matrixAddInto<T>(A21, A22, X);
+    strassenMultiplyRecursive<T>(X, B11, C21, workspace, cutoff);
+    matrixDeduct<T>(C22, C21);
+
+    // P4 = A22 * (B21 - B11)
+    matrixSubtractInto<T>(B21, B11, Y);
+    strassenMultiplyRecursive<T>(A22, Y, P, workspace, cutoff);
+    matrixAccumulate<T>(C11, P);
+    matrixAccumulate<T>(C21, P);
+
+    // P5 = (A11 + A22) * (B11 + B22)
+    matrixAddInto<T>(A11, A22, X);
+    matrixAddInto<T>(B11, B22, Y);
+    strassenMultiplyRecursive<T>(X, Y, P, workspace, cutoff);
+    matrixAccumulate<T>(C11, P);
+    matrixAccumulate<T>(C22, P);
+
+    // P6 = (A12 - A22) * (B21 + B22)
+    matrixSubtractInto<T>(A12, A22, X);
+    matrixAddInto<T>(B21, B22, Y);
+    strassenMultiplyRecursive<T>(X, Y, P, workspace, cutoff);
+    matrixAccumulate<T>(C11, P);
+
+    // P7 = (A11 - A21) * (B11 + B12)
+    matrixSubtractInto<T>(A11, A21, X);
+    matrixAddInto<T>(B11, B12, Y);
+    strassenMultiplyRecursive<T>(X, Y, P, workspace, cutoff);
+    matrixDeduct<T>(C22, P);
+
+    workspace.release(marker);
+
+    // Fold in whatever the odd dimensions left out of the even core
+    applyPeeling(matrixA, matrixB, matrixC, PEEL_INNER);
+    applyPeeling(matrixA, matrixB, matrixC, PEEL_COLUMN);
+    applyPeeling(matrixA, matrixB, matrixC, PEEL_ROW);
+}
+
+//Multiplies 2 matrices using Winograd's variant of Strassen's Algorithm - 7 products and only 15 additions per level:
+//   S1 = A21 + A22   S2 = S1 - A11    S3 = A11 - A21   S4 = A12 - S2
+//   T1 = B12 - B11   T2 = B22 - T1    T3 = B22 - B12   T4 = T2 - B21
+//   P1 = A11 * B11   P2 = A12 * B21   P3 = S4 * B22    P4 = A22 * T4
+//   P5 = S1 * T1     P6 = S2 * T2     P7 = S3 * T3
+//   C11 = P1 + P2    C12 = P1 + P6 + P5 + P3    C21 = P1 + P6 + P7 - P4    C22 = P1 + P6 + P7 + P5
+//The shared partial sum U2 = P1 + P6 and U3 = U2 + P7 are built inside the C quadrants, so the same
+//three scratch blocks (X, Y, P) as the classic recursion suffice. Odd dimensions are peeled the same way.
+template <typename T>
+void winogradMultiplyRecursive(ConstMatrixView<T> matrixA, ConstMatrixView<T> matrixB, MatrixView<T> matrixC,
+                               StrassenWorkspace<T> &workspace, int cutoff) {
+    int m = matrixC.rows, n = matrixC.cols, k = matrixA.cols;
+
+    // Base Case: Switch to the blocked kernel once any dimension is small
+    if (std::min({m, k, n}) <= cutoff) {
+        blockedMultiply(matrixA, matrixB, matrixC);
+        return;
+    }
+
+    int halfM = m / 2, halfK = k / 2, halfN = n / 2;
+
+    ConstMatrixView<T> evenA = matrixA.block(0, 0, 2 * halfM, 2 * halfK);
+    ConstMatrixView<T> evenB = matrixB.block(0, 0, 2 * halfK, 2 * halfN);
+    MatrixView<T> evenC = matrixC.block(0, 0, 2 * halfM, 2 * halfN);
+
+    ConstMatrixView<T> A11 = evenA.quadrant(0);
+    ConstMatrixView<T> A12 = evenA.quadrant(1);
+    ConstMatrixView<T> A21 = evenA.quadrant(2);
+    ConstMatrixView<T> A22 = evenA.quadrant(3);
+
+    ConstMatrixView<T> B11 = evenB.quadrant(0);
+    ConstMatrixView<T> B12 = evenB.quadrant(1);
+    ConstMatrixView<T> B21 = evenB.quadrant(2);
+    ConstMatrixView<T> B22 = evenB.quadrant(3);
+
+    MatrixView<T> C11 = evenC.quadrant(0);
+    MatrixView<T> C12 = evenC.quadrant(1);
+    MatrixView<T> C21 = evenC.quadrant(2);
+    MatrixView<T> C22 = evenC.quadrant(3);
+
+    size_t marker = workspace.mark();
+    MatrixView<T> X = workspace.allocate(halfM, halfK);
+    MatrixView<T> Y = workspace.allocate(halfK, halfN);
+    MatrixView<T> P = workspace.allocate(halfM, halfN);
+
+    // C21 = P7 = S3 * T3
+    matrixSubtractInto<T>(A11, A21, X);
+    matrixSubtractInto<T>(B22, B12, Y);
+    winogradMultiplyRecursive<T>(X, Y, C21, workspace, cutoff);
+
+    // C22 = P5 = S1 * T1
+    matrixAddInto<T>(A21, A22, X);
+    matrixSubtractInto<T>(B12, B11, Y);
+    winogradMultiplyRecursive<T>(X, Y, C22, workspace, cutoff);
+
+    // C12 = P6 = S2 * T2 (X and Y are updated in place from S1 and T1)
+    matrixDeduct<T>(X, A11);
+    matrixSubtractInto<T>(B22, Y, Y);
+    winogradMultiplyRecursive<T>(X, Y, C12, workspace, cutoff);
+
+    // P = P1, then C12 = U2 = P1 + P6, C21 = U3 = U2 + P7, C12 = U4 = U2 + P5, C22 = U7 = U3 + P5
+    winogradMultiplyRecursive<T>(A11, B11, P, workspace, cutoff);
+    matrixAccumulate<T>(C12, P);
+    matrixAccumulate<T>(C21, C12);
+    matrixAccumulate<T>(C12, C22);
+    matrixAccumulate<T>(C22, C21);
+
+    // C11 = P3 = S4 * B22, then C12 = U5 = U4 + P3 (final)
+    matrixSubtractInto<T>(A12, X, X);
+    winogradMultiplyRecursive<T>(X, B22, C11, workspace, cutoff);
+    matrixAccumulate<T>(C12, C11);
+
+    // C11 = P4 = A22 * T4, then C21 = U6 = U3 - P4 (final)
+    matrixDeduct<T>(Y, B21);
+    winogradMultiplyRecursive<T>(A22, Y, C11, workspace, cutoff);
+    matrixDeduct<T>(C21, C11);
+
+    // C11 = P2 = A12 * B21, then C11 = U1 = P1 + P2 (final)
+    winogradMultiplyRecursive<T>(A12, B21, C11, workspace, cutoff);
+    matrixAccumulate<T>(C11, P);
+
+    workspace.release(marker);
+
+    applyPeeling(matrixA, matrixB, matrixC, PEEL_INNER);
+    applyPeeling(matrixA, matrixB, matrixC, PEEL_COLUMN);
+    applyPeeling(matrixA, matrixB, matrixC, PEEL_ROW);
+}
+
+//Runs the serial recursion of the selected variant
+template <typename T>
+void serialMultiplyRecursive(ConstMatrixView<T> matrixA, ConstMatrixView<T> matrixB, MatrixView<T> matrixC,
+                             StrassenWorkspace<T> &workspace, MultiplyAlgorithm algorithm, int cutoff) {
+    if (algorithm == MultiplyAlgorithm::Winograd) {
+        winogradMultiplyRecursive(matrixA, matrixB, matrixC, workspace, cutoff);
+    } else {
+        strassenMultiplyRecursive(matrixA, matrixB, matrixC, workspace, cutoff);
+    }
+}
+
+// --- Parallel Strassen ---
+
+/**
+ * @brief One entry of a linear combination: quadrant/product 'index' scaled by 'sign' (+1 or -1).
+ */
+struct LinearTerm {
+    int index;
+    int sign;
+};
+
+/**
+ * @brief A Strassen-like scheme written as data. Product p multiplies the combination
+ * 'left[p]' of A's quadrants by the combination 'right[p]' of B's quadrants, and result
+ * quadrant q is the combination 'result[q]' of the seven products. Quadrants are numbered
+ * 0 = 11, 1 = 12, 2 = 21, 3 = 22. The parallel driver evaluates any scheme given this way.
+ */
+struct StrassenScheme {
+    std::vector<LinearTerm> left[7];
+    std::vector<LinearTerm> right[7];
+    std::vector<LinearTerm> result[4];
+};
+
+// The classic scheme used by strassenMultiplyRecursive (P1..P7 are products 0..6)
+inline const StrassenScheme CLASSIC_SCHEME = {
+    {{{0, 1}}, {{0, 1}, {1, 1}}, {{2, 1}, {3, 1}}, {{3, 1}}, {{0, 1}, {3, 1}}, {{1, 1}, {3, -1}}, {{0, 1}, {2, -1}}},
+    {{{1, 1}, {3, -1}}, {{3, 1}}, {{0, 1}}, {{2, 1}, {0, -1}}, {{0, 1}, {3, 1}}, {{2, 1}, {3, 1}}, {{0, 1}, {1, 1}}},
+    {{{4, 1}, {3, 1}, {1, -1}, {5, 1}}, {{0, 1}, {1, 1}}, {{2, 1}, {3, 1}}, {{4, 1}, {0, 1}, {2, -1}, {6, -1}}},
+};
+
+// Winograd's variant with its chained sums written out (S2 = A21 + A22 - A11 and so on), so that
+// every product task can form its operands independently of the others
+inline const StrassenScheme WINOGRAD_SCHEME = {
+    {{{0, 1}}, {{1, 1}}, {{1, 1}, {2, -1}, {3, -1}, {0, 1}}, {{3, 1}}, {{2, 1}, {3, 1}}, {{2, 1}, {3, 1}, {0, -1}}, {{0, 1}, {2, -1}}},
+    {{{0, 1}}, {{2, 1}}, {{3, 1}}, {{3, 1}, {1, -1}, {0, 1}, {2, -1}}, {{1, 1}, {0, -1}}, {{3, 1}, {1, -1}, {0, 1}}, {{3, 1}, {1, -1}}},
+    {{{0, 1}, {1, 1}}, {{0, 1}, {5, 1}, {4, 1}, {2, 1}}, {{0, 1}, {5, 1}, {6, 1}, {3, -1}}, {{0, 1}, {5, 1}, {6, 1}, {4, 1}}},
+};
+
+inline const StrassenScheme& schemeFor(MultiplyAlgorithm algorithm) {
+    return algorithm == MultiplyAlgorithm::Winograd ? WINOGRAD_SCHEME : CLASSIC_SCHEME;
+}
+
+//Picks the number of parallel levels: 7^depth products should cover each thread a couple of times over
+inline int defaultParallelDepth(unsigned threads) {
+    int depth = 0;
+    for (size_t tasks = 1; tasks < 2 * (size_t)threads; tasks *= 7) ++depth;
+    return depth;
+}
+
+//Writes the linear combination 'terms' of the given quadrants into 'out'
+template <typename T>
+void combineInto(const std::vector<LinearTerm> &terms, const ConstMatrixView<T> *parts, MatrixView<T> out) {
+    matrixCopy<T>(parts[terms[0].index], out, terms[0].sign < 0);
+    for (size_t t = 1; t < terms.size(); ++t) {
+        if (terms[t].sign > 0) {
+            matrixAccumulate<T>(out, parts[terms[t].index]);
+        } else {
+            matrixDeduct<T>(out, parts[terms[t].index]);
+        }
+    }
+}
+
+//A single positive term is used in place; anything else needs its own buffer
+inline bool needsOperandBuffer(const std::vector<LinearTerm> &terms) {
+    return terms.size() > 1 || terms[0].sign < 0;
+}
+
+/**
+ * @brief Workspace elements needed by strassenMultiplyParallel for an m x k by k x n multiply
+ * that fans out over 'depth' levels. Each parallel level keeps all seven products plus the
+ * operand sums alive at once and gives every product task a private slice for its own
+ * recursion, so the memory grows by roughly 7/4 per parallel level; below that the serial
+ * size applies.
+ */
+inline size_t strassenParallelWorkspaceSize(int m, int k, int n, int depth, const StrassenOptions &options) {
+    if (depth <= 0 || std::min({m, k, n}) <= options.cutoff) return strassenWorkspaceSize(m, k, n, options.cutoff);
+
+    const StrassenScheme &scheme = schemeFor(options.algorithm);
+    size_t halfM = m / 2, halfK = k / 2, halfN = n / 2;
+    size_t total = 7 * halfM * halfN;
+    for (int p = 0; p < 7; ++p) {
+        total += needsOperandBuffer(scheme.left[p]) * halfM * halfK;
+        total += needsOperandBuffer(scheme.right[p]) * halfK * halfN;
+        total += strassenParallelWorkspaceSize(halfM, halfK, halfN, depth - 1, options);
+    }
+    return total;
+}
+
+//Parallel version of the serial recursions. The top 'depth' levels run their seven products as
+//tasks on 'pool' (each task also forms its own operand sums), then build the four result quadrants
+//and the peeling fix-ups as further tasks. Deeper levels fall back to the serial recursion.
+template <typename T>
+void strassenMultiplyParallel(ConstMatrixView<T> matrixA, ConstMatrixView<T> matrixB, MatrixView<T> matrixC,
+                              StrassenWorkspace<T> &workspace, ThreadPool &pool, int depth,
+                              const StrassenOptions &options) {
+    int m = matrixC.rows, n = matrixC.cols, k = matrixA.cols;
+    if (depth <= 0 || std::min({m, k, n}) <= options.cutoff) {
+        serialMultiplyRecursive(matrixA, matrixB, matrixC, workspace, options.algorithm, options.cutoff);
+        return;
+    }
+
+    const StrassenScheme &scheme = schemeFor(options.algorithm);
+    int halfM = m / 2, halfK = k / 2, halfN = n / 2;
+    ConstMatrixView<T> evenA = matrixA.block(0, 0, 2 * halfM, 2 * halfK);
+    ConstMatrixView<T> evenB = matrixB.block(0, 0, 2 * halfK, 2 * halfN);
+    MatrixView<T> evenC = matrixC.block(0, 0, 2 * halfM, 2 * halfN);
+
+    ConstMatrixView<T> A[4], B[4];
+    MatrixView<T> C[4];
+    for (int q = 0; q < 4; ++q) {
+        A[q] = evenA.quadrant(q);
+        B[q] = evenB.quadrant(q);
+        C[q] = evenC.quadrant(q);
+    }
+
+    // Products and the private workspace of every product task are laid out before any task starts
+    size_t marker = workspace.mark();
+    ConstMatrixView<T> products[7];
+    MatrixView<T> productViews[7];
+    StrassenWorkspace<T> taskSpaces[7];
+    for (int p = 0; p < 7; ++p) {
+        productViews[p] = workspace.allocate(halfM, halfN);
+        products[p] = productViews[p];
+        size_t operands = needsOperandBuffer(scheme.left[p]) * (size_t)halfM * halfK +
+                          needsOperandBuffer(scheme.right[p]) * (size_t)halfK * halfN;
+        taskSpaces[p] = workspace.carve(operands + strassenParallelWorkspaceSize(halfM, halfK, halfN, depth - 1, options));
+    }
+
+    TaskGroup group(pool);
+    for (int p = 0; p < 7; ++p) {
+        group.run([&, p] {
+            StrassenWorkspace<T> &taskSpace = taskSpaces[p];
+            ConstMatrixView<T> left = A[scheme.left[p][0].index];
+            ConstMatrixView<T> right = B[scheme.right[p][0].index];
+            if (needsOperandBuffer(scheme.left[p])) {
+                MatrixView<T> sum = taskSpace.allocate(halfM, halfK);
+                combineInto(scheme.left[p], A, sum);
+                left = sum;
+            }
+            if (needsOperandBuffer(scheme.right[p])) {
+                MatrixView<T> sum = taskSpace.allocate(halfK, halfN);
+                combineInto(scheme.right[p], B, sum);
+                right = sum;
+            }
+            strassenMultiplyParallel(left, right, productViews[p], taskSpace, pool, depth - 1, options);
+        });
+    }
+    group.wait();
+
+    // The column and row fix-ups write outside the even core, so they overlap the combine step
+    for (int q = 0; q < 4; ++q) {
+        group.run([&, q] { combineInto(scheme.result[q], products, C[q]); });
+    }
+    group.run([&] { applyPeeling(matrixA, matrixB, matrixC, PEEL_COLUMN); });
+    group.run([&] { applyPeeling(matrixA, matrixB, matrixC, PEEL_ROW); });
+    group.wait();
+    applyPeeling(matrixA, matrixB, matrixC, PEEL_INNER);
+
+    workspace.release(marker);
+}
+
+// --- Strassen's Top-Level Functions ---
+
+/**
+ * @brief C = A * B with the blocked kernel, the rows of C split into bands, one task per band,
+ * that run on 'pool' (nullptr: the calling thread only) and on the calling thread.
+ */
+template <typename T>
+void blockedMultiplyOn(ConstMatrixView<T> matrixA, ConstMatrixView<T> matrixB, MatrixView<T> matrixC, ThreadPool* pool) {
+    if (pool == nullptr || pool->size() == 0 || matrixC.rows <= GEMM_MC) {
+        blockedMultiply(matrixA, matrixB, matrixC);
+        return;
+    }
+
+    // Bands are whole multiples of the packing block so no thread packs a partial block it could have shared
+    int bands = std::min((int)(pool->size() + 1) * 2, (matrixC.rows + GEMM_MC - 1) / GEMM_MC);
+    int bandRows = ((matrixC.rows + bands - 1) / bands + GEMM_MC - 1) / GEMM_MC * GEMM_MC;
+
+    TaskGroup group(*pool);
+    for (int row = 0; row < matrixC.rows; row += bandRows) {
+        int rows = std::min(bandRows, matrixC.rows - row);
+        group.run([&, row, rows] {
+            blockedMultiply(matrixA.block(row, 0, rows, matrixA.cols), matrixB, matrixC.block(row, 0, rows, matrixC.cols));
+        });
+    }
+    group.wait();
+}
+
+/**
+ * @brief Classic multiply of any m x k and k x n matrices with the blocked kernel, in bands of
+ * rows on 'pool' and the calling thread (see blockedMultiplyOn).
+ */
+template <typename T>
+Matrix<ResultType<T>> classicMultiplyOn(const Matrix<T> &matrixA, const Matrix<T> &matrixB, ThreadPool* pool) {
+    if constexpr (!std::is_same<T, ResultType<T>>::value) {
+        return classicMultiplyOn(convertMatrix<ResultType<T>>(matrixA), convertMatrix<ResultType<T>>(matrixB), pool);
+    } else {
+        Matrix<T> matrixC(matrixA.rows, matrixB.cols);
+        blockedMultiplyOn<T>(matrixA.view(), matrixB.view(), matrixC.view(), pool);
+        return matrixC;
+    }
+}
+
+//Classic multiply on options.threads threads in total (1 keeps it on the calling thread)
+template <typename T>
+Matrix<ResultType<T>> classicMultiply(const Matrix<T> &matrixA, const Matrix<T> &matrixB,
+                                      const StrassenOptions &options = StrassenOptions()) {
+    std::unique_ptr<ThreadPool> pool = matrixA.rows > GEMM_MC ? helperPool(options.threads) : nullptr;
+    return classicMultiplyOn(matrixA, matrixB, pool.get());
+}
+
+//Classic multiply on a pool the caller keeps, so repeated multiplies do not start threads each time
+template <typename T>
+Matrix<ResultType<T>> classicMultiply(const Matrix<T> &matrixA, const Matrix<T> &matrixB, ThreadPool &pool) {
+    return classicMultiplyOn(matrixA, matrixB, &pool);
+}
+
+/**
+ * @brief Shared body of the strassenMultiply overloads: the top levels of the recursion run on
+ * 'pool' (nullptr: all on the calling thread), as if on pool->size() + 1 threads; options.threads
+ * is not used.
+ */
+template <typename T>
+Matrix<ResultType<T>> strassenMultiplyOn(const Matrix<T> &matrixA, const Matrix<T> &matrixB,
+                                         StrassenWorkspace<ResultType<T>> &workspace, const StrassenOptions &options,
+                                         ThreadPool* pool) {
+    if (matrixA.cols != matrixB.rows) {
+        throw std::runtime_error("Error: Cannot multiply a " + std::to_string(matrixA.rows) + "x" +
+                                 std::to_string(matrixA.cols) + " matrix by a " + std::to_string(matrixB.rows) +
+                                 "x" + std::to_string(matrixB.cols) + " matrix.");
+    }
+    if (options.algorithm == MultiplyAlgorithm::Classic) {
+        return classicMultiplyOn(matrixA, matrixB, pool);
+    }
+    if constexpr (!std::is_same<T, ResultType<T>>::value) {
+        // Widen once so every operand sum and product of the recursion is formed in the result type
+        return strassenMultiplyOn(convertMatrix<ResultType<T>>(matrixA), convertMatrix<ResultType<T>>(matrixB),
+                                  workspace, options, pool);
+    } else {
+        int m = matrixA.rows, k = matrixA.cols, n = matrixB.cols;
+
+        StrassenOptions resolved = options;
+        if (resolved.cutoff <= 0) resolved.cutoff = DEFAULT_STRASSEN_CUTOFF;
+        resolved.cutoff = std::max(resolved.cutoff, 1);
+
+        int depth = 0;
+        if (pool != nullptr && pool->size() > 0) {
+            depth = options.parallelDepth >= 0 ? options.parallelDepth : defaultParallelDepth(pool->size() + 1);
+        }
+        workspace.reserve(strassenParallelWorkspaceSize(m, k, n, depth, resolved));
+
+        Matrix<T> matrixC(m, n);
+        if (depth == 0) {
+            serialMultiplyRecursive(matrixA.view(), matrixB.view(), matrixC.view(), workspace, resolved.algorithm,
+                                    resolved.cutoff);
+        } else {
+            strassenMultiplyParallel(matrixA.view(), matrixB.view(), matrixC.view(), workspace, *pool, depth, resolved);
+        }
+        return matrixC;
+    }
+}
+
+/**
+ * @brief Top-level function: multiplies an m x k matrix by a k x n matrix.
+ * No padding is needed; odd dimensions are peeled off at each level of the recursion.
+ * The workspace is grown once to fit this multiply, so a caller that keeps one workspace
+ * per thread pays for the temporaries only on the first (largest) multiply.
+ * With options.threads > 1 the top levels of the recursion run on a work-stealing pool.
+ */
+template <typename T>
+Matrix<ResultType<T>> strassenMultiply(const Matrix<T> &matrixA, const Matrix<T> &matrixB,
+                                       StrassenWorkspace<ResultType<T>> &workspace,
+                                       const StrassenOptions &options = StrassenOptions()) {
+    // No pool when nothing would run on it
+    std::unique_ptr<ThreadPool> pool;
+    if (options.parallelDepth != 0 || options.algorithm == MultiplyAlgorithm::Classic) pool = helperPool(options.threads);
+    return strassenMultiplyOn(matrixA, matrixB, workspace, options, pool.get());
+}
+
+/**
+ * @brief Same on a pool the caller keeps across multiplies: the recursion fans out as if on
+ * pool.size() + 1 threads, and no threads are started or joined per call.
+ */
+template <typename T>
+Matrix<ResultType<T>> strassenMultiply(const Matrix<T> &matrixA, const Matrix<T> &matrixB,
+                                       StrassenWorkspace<ResultType<T>> &workspace, ThreadPool &pool,
+                                       const StrassenOptions &options = StrassenOptions()) {
+    return strassenMultiplyOn(matrixA, matrixB, workspace, options, &pool);
+}
+
+/**
+ * @brief Convenience overload that uses a workspace private to this call.
+ */
+template <typename T>
+Matrix<ResultType<T>> strassenMultiply(const Matrix<T> &matrixA, const Matrix<T> &matrixB,
+                                       const StrassenOptions &options = StrassenOptions()) {
+    StrassenWorkspace<ResultType<T>> workspace;
+    return strassenMultiply(matrixA, matrixB, workspace, options);
+}
+
+//Same on a pool the caller keeps, with a workspace private to this call
+template <typename T>
+Matrix<ResultType<T>> strassenMultiply(const Matrix<T> &matrixA, const Matrix<T> &matrixB, ThreadPool &pool,
+                                       const StrassenOptions &options = StrassenOptions()) {
+    StrassenWorkspace<ResultType<T>> workspace;
+    return strassenMultiply(matrixA, matrixB, workspace, pool, options);
+}
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * Knapsack that answers the best profit at many capacities from one dynamic program.
+ *
+ * row[w] of the rolling row in knapsack.h is the maximum profit within weight w, for every w up
+ * to the capacity, not only at the capacity itself. So the object builds the row once up to the
+ * largest capacity it will be asked about and then reads any smaller capacity straight from it:
+ *   construction  O(n maxCapacity), on several threads if asked
+ *   profit        O(1)
+ *   addBrick      one more row update, O(maxCapacity) whatever its count
+ * Q capacities cost O(n maxCapacity + Q) instead of Q separate solves.
+*/
+
+#ifndef KNAPSACK_INCREMENTAL_KNAPSACK_H
+#define KNAPSACK_INCREMENTAL_KNAPSACK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "knapsack.h"
+
+//Profit is int64_t by default, since bricks added later may push the total past 32 bits
+template <typename Profit = int64_t>
+class IncrementalKnapsack {
+public:
+    //Row for capacities 0..maxCapacity with no bricks yet
+    explicit IncrementalKnapsack(int maxCapacity) : row(std::max(maxCapacity, 0) + 1, 0) {}
+
+    //Row for capacities 0..maxCapacity with 'bricks', brick i up to counts[i] times (no counts: once each).
+    //Bricks taken once each are solved on 'threads' threads.
+    IncrementalKnapsack(int maxCapacity, const std::vector<std::pair<int, int>>& bricks, const std::vector<int>& counts = {},
+                        unsigned threads = 1)
+        : IncrementalKnapsack(maxCapacity) {
+        if (!counts.empty() && counts.size() != bricks.size()) {
+            throw std::runtime_error("Error: There are " + std::to_string(bricks.size()) + " bricks but " +
+                                     std::to_string(counts.size()) + " counts.");
+        }
+        if (std::all_of(counts.begin(), counts.end(), [](int count) { return count == 1; })) {
+            std::unique_ptr<ThreadPool> pool = helperPool(threads);
+            knapsackRow(this->maxCapacity(), bricks, 0, (int)bricks.size(), row, pool.get());
+            added = bricks.size();
+            return;
+        }
+        for (size_t i = 0; i < bricks.size(); ++i) addBrick(bricks[i].first, bricks[i].second, counts[i]);
+    }
+
+    int maxCapacity() const { return (int)row.size() - 1; }
+    //Number of addBrick calls and constructor bricks so far
+    size_t bricks() const { return added; }
+
+    //Maximum profit of the bricks so far within 'capacity' (0 <= capacity <= maxCapacity())
+    Profit profit(int capacity) const {
+        if (capacity < 0 || capacity > maxCapacity()) {
+            throw std::runtime_error("Error: Capacity " + std::to_string(capacity) + " is outside the range 0.." +
+                                     std::to_string(maxCapacity()) + " this knapsack was built for.");
+        }
+        return row[capacity];
+    }
+
+    //Every answer at once: profits()[w] is profit(w)
+    const std::vector<Profit>& profits() const { return row; }
+
+    //Adds a brick that may be taken up to 'count' times (negative: any number of times) without a rebuild
+    void addBrick(int value, int weight, int count = 1) {
+        knapsackItem(row, maxCapacity(), (Profit)value, weight, count, sequence, queue);
+        ++added;
+    }
+
+private:
+    std::vector<Profit> row;
+    size_t added = 0;
+    // Scratch space of the bounded update, kept between bricks
+    std::vector<Profit> sequence;
+    std::vector<int> queue;
+};
+
+#endif
@@ -4,150 +4,212 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
 
-using namespace std;
-
-//Uses Dynamic Programming to determine the maximum profit that can be extracted given certain weight restrictions of the things that will be carried in a knapsack
-int knapsack(int capacity, const vector<pair<int, int>>& bricks) {
-    int n = bricks.size();
-
-    //DP table: dp[i][w] stores the maximum value using a subset of the first 'i' items with a total weight of exactly 'w'
-    //Dimension: (n + 1) rows for items, (capacity + 1) columns for weight
-    vector<vector<int>> dp(n + 1, vector<int>(capacity + 1, 0));
-
-    //Iterates through each item
-    for (int i = 1; i <= n; ++i) {
-        //Current item's value and weight
-        int current_value = bricks[i - 1].first;
-        int current_weight = bricks[i - 1].second;
-
-        //Iterates through each possible weight from 0 up to capacity
-        for (int w = 1; w <= capacity; ++w) {
-            
-            //Case 1: The current item's weight is more than the current capacity 'w', so can't be included
-            if (current_weight > w) {
-                dp[i][w] = dp[i - 1][w];
-            } 
-            //Case 2: The current item can be included
-            else {
-                //Option A: DO NOT include the current item
-                //The max value is the same as the max value from the previous (i-1) items
-                int value_without_item = dp[i - 1][w];
-
-                //Option B: INCLUDE the current item
-                //The max value is the item's value PLUS the max value from the previous (i-1) items with the remaining capacity (w - current_weight)
-                int value_with_item = current_value + dp[i - 1][w - current_weight];
-
-                //Takes the maximum of the two options
-                dp[i][w] = max(value_without_item, value_with_item);
-            }
-        }
-    }
+#include "../../Common/fastInput.h"
+#include "incrementalKnapsack.h"
+#include "knapsack.h"
+#include "knapsackStrategies.h"
 
-    //The result is the maximum value achieved using all 'n' items  with the full 'capacity' W
-    return dp[n][capacity];
-}
+using namespace std;
 
-//Reads and parses the knapsack input from a text file, storing the results in the provided reference parameters
+//Reads and parses the knapsack input from a text or binary file, storing the results in the provided reference parameters
+//The input is the capacity followed by (value, weight, count) triples; braces, commas and spaces only separate the numbers
 //.   filename: The name of the input file (e.g., "input.txt")
 //.   capacity_ref: A reference to store the maximum knapsack weight
 //.   bricks_ref A: reference to store the vector of {value, weight} pairs
+//.   counts_ref: A reference to store how many copies of each brick there are (negative: unlimited)
 bool read_input_from_file(
     const string& filename, 
-    int& capacity_ref, 
-    vector<pair<int, int>>& bricks_ref) {
+    int64_t& capacity_ref, 
+    vector<pair<int, int>>& bricks_ref,
+    vector<int>& counts_ref) {
     
-    ifstream file(filename);
-    string line;
+    vector<int64_t> numbers;
+    string error;
+    if (!readIntegerList(filename, numbers, error)) {
+        cerr << "Error: " << error << endl;
+        return false;
+    }
 
-    if (!file.is_open()) {
-        cerr << "Error: Could not open file " << filename << endl;
+    // The capacity, then (value, weight, count) triples; out-of-range numbers are rejected rather than truncated
+    if (!knapsackInput(numbers, capacity_ref, bricks_ref, counts_ref, error)) {
+        cerr << "Error: " << error << " in " << filename << "." << endl;
         return false;
     }
+    if ((numbers.size() - 1) % 3 != 0) {
+        cerr << "Error: Ignoring an incomplete brick at the end of " << filename << endl;
+    }
 
-    // Read the single line of input
-    getline(file, line);
-    file.close();
+    return true;
+}
 
-    // Clean up the string to remove structural braces and spaces
-    string cleaned_line;
-    for (char c : line) {
-        if (c != '{' && c != '}' && c != ' ') {
-            cleaned_line += c;
+//Runs program above with a given example
+//Usage: knapsack [--unbounded] [--time-limit SECONDS] [--threads N] [--reach WEIGHT] [--capacities C1,C2,...] [file]
+//Every brick can be taken up to its count times (a negative count means any number of times);
+//with all counts 1 this is the 0/1 knapsack, and --unbounded lifts every limit.
+//The 0/1 knapsack picks its strategy from the bricks (see knapsackStrategies.h); when it has to
+//branch and bound, --time-limit caps the search and the answer comes with its optimality gap.
+//--threads splits the weight table over N threads; --reach only answers whether some of the
+//bricks weigh exactly WEIGHT; --capacities gives the best profit at each of the listed
+//capacities instead of the file's, all from one table.
+//       knapsack --to-binary input output   (binary inputs load without parsing)
+int main(int argc, char* argv[]) {
+    if (argc == 4 && string(argv[1]) == "--to-binary") {
+        string error;
+        if (!convertIntegerListToBinary(argv[2], argv[3], error)) {
+            cerr << "Error: " << error << endl;
+            return 1;
         }
+        return 0;
     }
-    
-    // Use a stringstream to parse comma-separated values
-    stringstream ss(cleaned_line);
-    string segment;
-
-    // The first segment is the capacity
-    if (getline(ss, segment, ',')) {
-        try {
-            capacity_ref = stoi(segment);
-        } catch (const invalid_argument& e) {
-            cerr << "Error parsing capacity: " << segment << endl;
-            return false;
+    string FILENAME = "example.txt";
+    bool unbounded = false;
+    double time_limit = KNAPSACK_DEFAULT_SECONDS;
+    unsigned threads = 1;
+    int reach = -1;
+    vector<int> capacities;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--unbounded") unbounded = true;
+        else if (arg == "--time-limit" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], time_limit)) return badFlagValue(arg, argv[i]);
         }
-    } else {
-        return false; // Failed to read capacity
-    }
-
-    // Process the remaining segments (value, weight, count)
-    while (getline(ss, segment, ',')) {
-        // Read the value (v)
-        int v;
-        try {
-            v = stoi(segment);
-        } catch (const invalid_argument& e) {
-            cerr << "Error parsing brick value: " << segment << endl;
-            continue;
+        else if (arg == "--threads" && i + 1 < argc) {
+            int count = 0;
+            if (!parseNumber(argv[++i], count)) return badFlagValue(arg, argv[i]);
+            threads = max(1, count);
         }
-        
-        // Read the weight (w)
-        if (!getline(ss, segment, ',')) break;
-        int w;
-        try {
-            w = stoi(segment);
-        } catch (const invalid_argument& e) {
-            cerr << "Error parsing brick weight: " << segment << endl;
-            continue;
+        else if (arg == "--reach" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], reach)) return badFlagValue(arg, argv[i]);
         }
-        
-        // Read and ignore the count (always '1' for 0/1 Knapsack)
-        if (!getline(ss, segment, ',')) break;
-        
-        // Store the {value, weight} pair
-        bricks_ref.push_back({v, w});
+        else if (arg == "--capacities" && i + 1 < argc) {
+            stringstream list(argv[++i]);
+            string capacity;
+            while (getline(list, capacity, ',')) {
+                int value = 0;
+                if (!parseNumber(capacity, value)) return badFlagValue(arg, capacity);
+                if (value < 0) return badFlagValue(arg, capacity, "capacities of at least 0");
+                capacities.push_back(value);
+            }
+        }
+        else FILENAME = arg;
     }
-
-    return true;
-}
-
-//Runs program above with a given example
-int main() {
-    const string FILENAME = "example.txt";
-    int knapsack_capacity = 0;
+    int64_t knapsack_capacity = 0;
     vector<pair<int, int>> brick_data; // Stores {value, weight}
+    vector<int> brick_counts;
 
     //1. Reads and parses the input from the file
     cout << "Attempting to read input from: " << FILENAME << endl;
-    bool success = read_input_from_file(FILENAME, knapsack_capacity, brick_data);
+    bool success = read_input_from_file(FILENAME, knapsack_capacity, brick_data, brick_counts);
 
     if (!success || knapsack_capacity <= 0 || brick_data.empty()) {
         cerr << "\nExiting due to invalid or missing input data." << endl;
         return 1;
     }
 
-    //2. Calculate sthe maximum profit
-    int max_profit = knapsack(knapsack_capacity, brick_data);
+    //Feasibility query: only the weights matter, and the subset-sum bitset answers it
+    if (reach >= 0) {
+        vector<int> weights;
+        for (size_t i = 0; i < brick_data.size(); ++i) {
+            int weight = brick_data[i].second;
+            if (weight <= 0) continue;
+            //An unlimited brick can be used at most reach / weight times anyway
+            int copies = (unbounded || brick_counts[i] < 0) ? reach / weight : min(brick_counts[i], reach / weight);
+            //Bundles of 1, 2, 4, ... copies and the remainder add up to every count from 0 to 'copies',
+            //so O(log copies) weights stand in for the copies themselves
+            for (int bundle = 1; copies > 0; bundle *= 2) {
+                int size = min(bundle, copies);
+                weights.push_back(size * weight);
+                copies -= size;
+            }
+        }
+        unique_ptr<ThreadPool> pool = helperPool(threads);
+        cout << "Can some of the bricks weigh exactly " << reach << "? " << (subsetSumReaches(reach, weights, pool.get()) ? "yes" : "no")
+             << endl;
+        return 0;
+    }
+
+    //What-if sweep: one table up to the largest capacity answers all of them
+    if (!capacities.empty()) {
+        if (unbounded) fill(brick_counts.begin(), brick_counts.end(), UNLIMITED_COUNT);
+        int largest = *max_element(capacities.begin(), capacities.end());
+        try {
+            IncrementalKnapsack<> sweep(largest, brick_data, brick_counts, threads);
+            for (int capacity : capacities) {
+                cout << "Capacity " << capacity << ": maximum profit " << sweep.profit(capacity) << endl;
+            }
+        } catch (const bad_alloc&) {
+            cerr << "Error: Not enough memory for a knapsack with capacity " << largest << "." << endl;
+            return 1;
+        } catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    //2. Calculates the maximum profit (in 64 bits when 32 could overflow) and, for the 0/1 knapsack, which bricks make it up
+    if (unbounded) fill(brick_counts.begin(), brick_counts.end(), UNLIMITED_COUNT);
+    bool zero_one = all_of(brick_counts.begin(), brick_counts.end(), [](int count) { return count == 1; });
+    //Only the 0/1 knapsack has strategies that do not index a table by weight, so the others stop
+    //at the table size the 0/1 strategy selector allows itself
+    if (!zero_one && knapsack_capacity > KNAPSACK_MAX_TABLE) {
+        cerr << "Error: Bounded and unbounded knapsacks support capacities up to " << KNAPSACK_MAX_TABLE << "." << endl;
+        return 1;
+    }
+    long long max_profit;
+    vector<int> taken;
+    KnapsackAnswer answer;
+    if (zero_one) {
+        //Large capacities are solved without the weight table, and then without the selection
+        try {
+            answer = adaptiveKnapsack(knapsack_capacity, brick_data, time_limit, threads, &taken);
+        } catch (const bad_alloc&) {
+            cerr << "Error: Not enough memory for a knapsack with capacity " << knapsack_capacity << "." << endl;
+            return 1;
+        } catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+        max_profit = answer.profit;
+    } else {
+        int capacity = (int)knapsack_capacity;
+        bool wide = knapsackNeedsInt64(capacity, brick_data, brick_counts);
+        try {
+            max_profit = wide ? boundedKnapsack<int64_t>(capacity, brick_data, brick_counts)
+                              : boundedKnapsack(capacity, brick_data, brick_counts);
+        } catch (const bad_alloc&) {
+            cerr << "Error: Not enough memory for a knapsack with capacity " << knapsack_capacity << "." << endl;
+            return 1;
+        } catch (const runtime_error& e) {
+            cerr << e.what() << endl;
+            return 1;
+        }
+    }
+    long long taken_weight = 0;
+    for (int brick : taken) taken_weight += brick_data[brick].second;
 
     //3. Outputs the result
-    cout << "\n--- 0/1 Knapsack Solution ---" << endl;
+    cout << (zero_one ? "\n--- 0/1 Knapsack Solution ---" : unbounded ? "\n--- Unbounded Knapsack Solution ---" : "\n--- Bounded Knapsack Solution ---") << endl;
     cout << "Knapsack Capacity: " << knapsack_capacity << endl;
     cout << "Number of Bricks: " << brick_data.size() << endl;
     cout << "---------------------------------------" << endl;
-    cout << "The maximum total potential profit that can be stolen is: " << max_profit << endl;
+    if (zero_one) cout << "Strategy: " << knapsackStrategyName(answer.strategy) << endl;
+    if (zero_one && !answer.optimal()) {
+        cout << "Time limit reached; the best profit found is: " << max_profit << endl;
+        cout << "The maximum is proven to be at most " << answer.bound << " (gap " << answer.bound - max_profit << ")" << endl;
+    } else {
+        cout << "The maximum total potential profit that can be stolen is: " << max_profit << endl;
+    }
+    if (zero_one && answer.selected) {
+        cout << "Bricks taken (" << taken.size() << ", total weight " << taken_weight << "):";
+        for (int brick : taken) cout << " " << brick + 1;
+        cout << endl;
+    }
     cout << "---------------------------------------" << endl;
 
     return 0;
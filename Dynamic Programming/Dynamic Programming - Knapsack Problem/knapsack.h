@@ -0,0 +1,354 @@
+/**
+ * Knapsack solvers: the most profit a knapsack of a given capacity can carry when every
+ * brick (value, weight) is either taken whole or left behind.
+ *
+ * The table dp[i][w] of the textbook solution only ever reads row i - 1 while it fills row i,
+ * so knapsack() keeps a single row of capacity + 1 entries and updates it in place, from the
+ * largest weight down so that every entry it reads still belongs to the previous row.
+ *
+ * Without the table the chosen bricks cannot be traced back, so knapsackSelection() finds them
+ * by divide and conquer instead (after Hirschberg's linear-space alignment): the rows of the
+ * first and of the second half of the bricks tell how the best solution splits the capacity
+ * between the halves, and each half is then solved on its own share. Every level of the
+ * recursion costs at most half as much as the one above, so the whole search takes about twice
+ * the time of knapsack() and O(capacity) memory.
+ *
+ * boundedKnapsack() lets brick i be taken up to counts[i] times (unboundedKnapsack() any number
+ * of times) in O(n capacity) time whatever the counts, with a sliding-window maximum per brick
+ * instead of expanding the copies into separate 0/1 bricks.
+ *
+ * The row update itself is the SIMD kernel of knapsackKernels.h. Profits are int32_t or, for
+ * bricks whose total value may not fit in 32 bits, int64_t. Weights are expected to be
+ * non-negative.
+ *
+ * knapsack() and knapsackSelection() can also split every row update across threads: each brick
+ * becomes one task per range of the capacity, and the bricks follow each other with one barrier
+ * (TaskGroup::wait) between them. When every brick's value equals its weight the problem is
+ * subset sum, and a bitset of the reachable weights replaces the row: 64 weights per word
+ * instead of one per int.
+ *
+ * Kept apart from knapsack.cpp so that other programs, like the batch solver, can call it.
+*/
+
+#ifndef KNAPSACK_KNAPSACK_H
+#define KNAPSACK_KNAPSACK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../Common/threadPool.h"
+#include "knapsackKernels.h"
+
+// Fewest row entries (or bitset words) a task of a parallel row update gets
+const int KNAPSACK_PARALLEL_MIN_ENTRIES = 1 << 15;
+
+//Runs update(first, last) over ranges covering [0, entries) on the pool and the calling thread,
+//and returns once every range is done; all on the calling thread without a pool
+template <typename RangeUpdate>
+void knapsackParallelFor(ThreadPool* pool, int entries, RangeUpdate update) {
+    int tasks = pool == nullptr ? 1 : std::min((int)pool->size() + 1, std::max(1, entries / KNAPSACK_PARALLEL_MIN_ENTRIES));
+    if (tasks == 1) {
+        update(0, entries);
+        return;
+    }
+    TaskGroup group(*pool);
+    for (int t = 1; t < tasks; ++t) {
+        group.run([&update, entries, tasks, t] {
+            update((int)((int64_t)entries * t / tasks), (int)((int64_t)entries * (t + 1) / tasks));
+        });
+    }
+    update(0, (int)((int64_t)entries / tasks));
+    group.wait();
+}
+
+//Fills row[w] (w = 0..capacity) with the maximum profit of bricks [first, last) within weight w,
+//splitting every brick's update over 'pool' if there is one
+template <typename Profit>
+void knapsackRow(int capacity, const std::vector<std::pair<int, int>>& bricks, int first, int last,
+                 std::vector<Profit>& row, ThreadPool* pool = nullptr) {
+    row.assign(capacity + 1, 0);
+    if (pool == nullptr || capacity < 2 * KNAPSACK_PARALLEL_MIN_ENTRIES) {
+        KnapsackItemKernel<Profit> relax = selectKnapsackKernel<Profit>();
+        for (int i = first; i < last; ++i) {
+            //Heavier weights are updated first, so row[w - weight] still holds the value without brick i
+            relax(row.data(), capacity, (Profit)bricks[i].first, bricks[i].second);
+        }
+        return;
+    }
+    //Every range of the capacity is updated in place by its own task, from the top down as usual.
+    //Only the entries below a range belong to a neighbour, which may be rewriting them already, so
+    //a task reads those from 'edges', where their owner copied them at the end of the last brick.
+    std::vector<int> items;
+    for (int i = first; i < last; ++i) {
+        if (bricks[i].first > 0 && bricks[i].second <= capacity) items.push_back(i); // Others leave the row as it is
+    }
+    KnapsackItemKernel<Profit> relax = selectKnapsackKernel<Profit>();
+    KnapsackRangeKernel<Profit> relaxFromEdge = selectKnapsackRangeKernel<Profit>();
+    //Brick k reads edges[k % 2] and fills edges[(k + 1) % 2] for the next one; both start as the empty row
+    std::vector<Profit> edges[2] = {std::vector<Profit>(capacity + 1, 0), std::vector<Profit>(capacity + 1, 0)};
+    for (size_t k = 0; k < items.size(); ++k) {
+        Profit value = bricks[items[k]].first;
+        int weight = bricks[items[k]].second;
+        int nextWeight = k + 1 < items.size() ? bricks[items[k + 1]].second : 0;
+        const std::vector<Profit>& edge = edges[k % 2];
+        std::vector<Profit>& nextEdge = edges[(k + 1) % 2];
+        knapsackParallelFor(pool, capacity + 1, [&](int low, int high) {
+            relax(row.data() + low, high - 1 - low, value, weight); // Entries [low + weight, high)
+            int end = std::min(high, low + weight);
+            if (std::max(low, weight) < end) relaxFromEdge(edge.data(), row.data(), std::max(low, weight), end, value, weight);
+            //The top of the range is what the next brick reads from below
+            int keep = std::max(low, high - nextWeight);
+            std::copy(row.begin() + keep, row.begin() + high, nextEdge.begin() + keep);
+        });
+    }
+}
+
+//Count of a brick that may be taken any number of times (any negative count means the same)
+const int UNLIMITED_COUNT = -1;
+
+//Reads the capacity and the (value, weight, count) triples that follow it in 'numbers'; a trailing
+//incomplete triple is left out. Returns false and explains why in 'error' if the capacity is not
+//positive, or a value, weight or count does not fit in int (weights must also be non-negative),
+//instead of letting them wrap around.
+inline bool knapsackInput(const std::vector<int64_t>& numbers, int64_t& capacity, std::vector<std::pair<int, int>>& bricks,
+                          std::vector<int>& counts, std::string& error) {
+    bricks.clear();
+    counts.clear();
+    if (numbers.empty() || numbers[0] <= 0) {
+        error = "The capacity must be a positive number";
+        return false;
+    }
+    capacity = numbers[0];
+    auto fits = [](int64_t number, int64_t low) { return number >= low && number <= INT32_MAX; };
+    for (size_t i = 1; i + 3 <= numbers.size(); i += 3) {
+        int64_t value = numbers[i], weight = numbers[i + 1], count = numbers[i + 2];
+        if (!fits(value, INT32_MIN) || !fits(weight, 0) || !fits(count, INT32_MIN)) {
+            error = "Brick " + std::to_string(i / 3 + 1) + " (" + std::to_string(value) + ", " + std::to_string(weight) + ", " +
+                    std::to_string(count) + ") needs a value and a count that fit in 32 bits and a weight from 0 to " +
+                    std::to_string(INT32_MAX);
+            return false;
+        }
+        bricks.push_back({(int)value, (int)weight});
+        counts.push_back((int)count);
+    }
+    return true;
+}
+
+//True when the best profit may not fit in int32_t: the positive values of all the copies of every
+//brick that fit in 'capacity' add up past it. No counts means one copy of each brick.
+inline bool knapsackNeedsInt64(int capacity, const std::vector<std::pair<int, int>>& bricks,
+                               const std::vector<int>& counts = {}) {
+    int64_t total = 0;
+    for (size_t i = 0; i < bricks.size(); ++i) {
+        int value = bricks[i].first, weight = bricks[i].second;
+        int64_t copies = counts.empty() ? 1 : counts[i];
+        if (weight > 0 && (copies < 0 || copies > capacity / weight)) copies = capacity / weight;
+        if (copies < 0) return true; // Unlimited weightless bricks are rejected by the solver anyway
+        total += copies * std::max(value, 0);
+        if (total > INT32_MAX) return true;
+    }
+    return false;
+}
+
+// --- Subset Sum ---
+
+//Bit s (bit s % 64 of word s / 64) is set when some of the weights add up to exactly s, for s = 0..capacity.
+//'untilCapacity' stops as soon as the capacity itself is reachable, leaving the sums below it incomplete.
+inline std::vector<uint64_t> subsetSums(int capacity, const std::vector<int>& weights, ThreadPool* pool = nullptr,
+                                        bool untilCapacity = false) {
+    int words = capacity / 64 + 1;
+    std::vector<uint64_t> bits(words, 0), next(words, 0);
+    bits[0] = 1;
+    SubsetSumRangeKernel add = selectSubsetSumRangeKernel();
+    int64_t total = 0; // No sum past the weights seen so far is reachable, so the words above it stay 0
+    for (int weight : weights) {
+        if (weight <= 0 || weight > capacity) continue;
+        total = std::min<int64_t>(total + weight, capacity);
+        int live = (int)(total / 64) + 1;
+        knapsackParallelFor(pool, live, [&](int low, int high) { add(bits.data(), next.data(), low, high, weight); });
+        bits.swap(next);
+        if (untilCapacity && (bits[capacity / 64] >> (capacity % 64) & 1)) break;
+    }
+    //Sums past the capacity in the last word are not part of the answer
+    if (capacity % 64 != 63) bits.back() &= (uint64_t(2) << (capacity % 64)) - 1;
+    return bits;
+}
+
+//Largest total of some of the weights that does not exceed 'capacity'
+inline int subsetSum(int capacity, const std::vector<int>& weights, ThreadPool* pool = nullptr) {
+    std::vector<uint64_t> bits = subsetSums(capacity, weights, pool, true);
+    for (int word = (int)bits.size() - 1; word >= 0; --word) {
+        for (int bit = 63; bit >= 0; --bit) {
+            if (bits[word] >> bit & 1) return word * 64 + bit;
+        }
+    }
+    return 0;
+}
+
+//Yes/no query: whether some of the weights add up to exactly 'target'
+inline bool subsetSumReaches(int target, const std::vector<int>& weights, ThreadPool* pool = nullptr) {
+    if (target < 0) return false;
+    std::vector<uint64_t> bits = subsetSums(target, weights, pool, true);
+    return bits[target / 64] >> (target % 64) & 1;
+}
+
+//True when every brick is worth exactly its weight, so the knapsack is subset sum
+inline bool knapsackIsSubsetSum(const std::vector<std::pair<int, int>>& bricks) {
+    for (const std::pair<int, int>& brick : bricks) {
+        if (brick.first != brick.second || brick.second < 0) return false;
+    }
+    return true;
+}
+
+// --- 0/1 Knapsack ---
+
+//Uses Dynamic Programming to determine the maximum profit that can be extracted given certain weight restrictions of the things that will be carried in a knapsack
+//Profit is int32_t by default; int64_t when the total value of the bricks may not fit in 32 bits.
+//A pool splits every row update (nullptr: the calling thread only); bricks worth their weight go to the subset-sum bitset.
+template <typename Profit = int32_t>
+Profit knapsack(int capacity, const std::vector<std::pair<int, int>>& bricks, ThreadPool* pool) {
+    if (knapsackIsSubsetSum(bricks)) {
+        std::vector<int> weights;
+        for (const std::pair<int, int>& brick : bricks) weights.push_back(brick.second);
+        return (Profit)subsetSum(capacity, weights, pool);
+    }
+
+    //One row of the DP table: row[w] is the maximum value of the items seen so far within weight 'w'
+    std::vector<Profit> row;
+    knapsackRow(capacity, bricks, 0, (int)bricks.size(), row, pool);
+
+    //The result is the maximum value achieved using all items with the full capacity
+    return row[capacity];
+}
+
+//Same, on a pool the caller keeps across calls
+template <typename Profit = int32_t>
+Profit knapsack(int capacity, const std::vector<std::pair<int, int>>& bricks, ThreadPool& pool) {
+    return knapsack<Profit>(capacity, bricks, &pool);
+}
+
+//Same, on 'threads' threads in total (1 keeps it on the calling thread)
+template <typename Profit = int32_t>
+Profit knapsack(int capacity, const std::vector<std::pair<int, int>>& bricks, unsigned threads = 1) {
+    std::unique_ptr<ThreadPool> pool = helperPool(threads);
+    return knapsack<Profit>(capacity, bricks, pool.get());
+}
+
+//Appends to 'chosen' the bricks of [first, last) that one best selection within 'capacity' takes
+template <typename Profit>
+void knapsackSelectRange(int capacity, const std::vector<std::pair<int, int>>& bricks, int first, int last,
+                         std::vector<int>& chosen, ThreadPool* pool = nullptr) {
+    if (last - first == 1) {
+        if (bricks[first].second <= capacity && bricks[first].first > 0) chosen.push_back(first);
+        return;
+    }
+    int middle = first + (last - first) / 2;
+    int leftCapacity = 0;
+    {
+        //Best split of the capacity: left[c] + right[capacity - c] is the best profit when the first half gets c
+        std::vector<Profit> left, right;
+        knapsackRow(capacity, bricks, first, middle, left, pool);
+        knapsackRow(capacity, bricks, middle, last, right, pool);
+        for (int c = 1; c <= capacity; ++c) {
+            if (left[c] + right[capacity - c] > left[leftCapacity] + right[capacity - leftCapacity]) leftCapacity = c;
+        }
+    } // Both rows are freed before the recursion, so only one level holds rows at a time
+    knapsackSelectRange<Profit>(leftCapacity, bricks, first, middle, chosen, pool);
+    knapsackSelectRange<Profit>(capacity - leftCapacity, bricks, middle, last, chosen, pool);
+}
+
+//Indices (in increasing order) of the bricks one best selection within 'capacity' takes, found in O(capacity) memory
+template <typename Profit = int32_t>
+std::vector<int> knapsackSelection(int capacity, const std::vector<std::pair<int, int>>& bricks, ThreadPool* pool) {
+    std::vector<int> chosen;
+    if (!bricks.empty() && capacity >= 0) knapsackSelectRange<Profit>(capacity, bricks, 0, (int)bricks.size(), chosen, pool);
+    return chosen;
+}
+
+//Same, on a pool the caller keeps across calls
+template <typename Profit = int32_t>
+std::vector<int> knapsackSelection(int capacity, const std::vector<std::pair<int, int>>& bricks, ThreadPool& pool) {
+    return knapsackSelection<Profit>(capacity, bricks, &pool);
+}
+
+//Same, on 'threads' threads in total (1 keeps it on the calling thread)
+template <typename Profit = int32_t>
+std::vector<int> knapsackSelection(int capacity, const std::vector<std::pair<int, int>>& bricks, unsigned threads = 1) {
+    std::unique_ptr<ThreadPool> pool = helperPool(threads);
+    return knapsackSelection<Profit>(capacity, bricks, pool.get());
+}
+
+// --- Bounded and Unbounded Knapsack ---
+
+/**
+ * @brief Adds up to 'count' copies of one brick (value, weight) to the row, or any number when
+ * count is negative. With c = count, the new row is
+ *   row[w] = max over t = 0..c of old[w - t weight] + t value
+ * The entries w = r, r + weight, r + 2 weight, ... of one residue r form a sequence on their
+ * own, and along it the max runs over a window of the last c + 1 entries, so a monotone queue
+ * of candidates (sliding-window maximum) gives every entry in O(1) amortized, whatever the
+ * count. A single copy uses the 0/1 kernel and a count that covers the whole capacity is
+ * unbounded, which one upward pass handles.
+ */
+template <typename Profit>
+void knapsackItem(std::vector<Profit>& row, int capacity, Profit value, int weight, int count,
+                  std::vector<Profit>& sequence, std::vector<int>& queue) {
+    if (count == 0 || value <= 0 || weight > capacity) return; // Taking it never helps
+    if (weight == 0) {
+        if (count < 0) throw std::runtime_error("Error: A weightless brick with a value and no count limit makes the profit unbounded.");
+        for (Profit& entry : row) entry += value * count;
+        return;
+    }
+    if (count == 1) {
+        selectKnapsackKernel<Profit>()(row.data(), capacity, value, weight);
+        return;
+    }
+    if (count < 0 || (int64_t)count * weight >= capacity) {
+        //Lighter weights first: row[w - weight] may already hold copies of this brick
+        for (int w = weight; w <= capacity; ++w) {
+            Profit candidate = value + row[w - weight];
+            if (candidate > row[w]) row[w] = candidate;
+        }
+        return;
+    }
+
+    sequence.resize(capacity / weight + 1);
+    queue.resize(sequence.size());
+    for (int r = 0; r < weight; ++r) {
+        int steps = (capacity - r) / weight + 1;
+        for (int j = 0; j < steps; ++j) sequence[j] = row[r + j * weight];
+        //queue[head..tail) holds the steps whose old entry can still win, best first; step q is
+        //worth sequence[q] + (j - q) value at step j, and j - q <= count keeps that within range
+        int head = 0, tail = 0;
+        for (int j = 0; j < steps; ++j) {
+            while (tail > head && sequence[queue[tail - 1]] + (Profit)(j - queue[tail - 1]) * value <= sequence[j]) --tail;
+            queue[tail++] = j;
+            if (queue[head] < j - count) ++head;
+            row[r + j * weight] = sequence[queue[head]] + (Profit)(j - queue[head]) * value;
+        }
+    }
+}
+
+//Maximum profit within 'capacity' when brick i may be taken up to counts[i] times (negative: any number of times)
+template <typename Profit = int32_t>
+Profit boundedKnapsack(int capacity, const std::vector<std::pair<int, int>>& bricks, const std::vector<int>& counts) {
+    std::vector<Profit> row(capacity + 1, 0), sequence;
+    std::vector<int> queue;
+    for (size_t i = 0; i < bricks.size(); ++i) {
+        knapsackItem(row, capacity, (Profit)bricks[i].first, bricks[i].second, counts[i], sequence, queue);
+    }
+    return row[capacity];
+}
+
+//Maximum profit within 'capacity' when every brick may be taken any number of times
+template <typename Profit = int32_t>
+Profit unboundedKnapsack(int capacity, const std::vector<std::pair<int, int>>& bricks) {
+    return boundedKnapsack<Profit>(capacity, bricks, std::vector<int>(bricks.size(), UNLIMITED_COUNT));
+}
+
+#endif
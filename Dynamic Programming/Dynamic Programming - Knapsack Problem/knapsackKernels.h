@@ -0,0 +1,121 @@
+/**
+ * Row update of the knapsack dynamic program, the loop every solver in knapsack.h spends its
+ * time in:
+ *   row[w] = max(row[w], value + row[w - weight])   for w = capacity down to weight
+ * It is an element-wise max of the row and a shifted copy of itself, so it vectorizes - except
+ * that the compiler cannot see that going downwards only ever reads entries that have not been
+ * updated yet, and keeps the loop scalar. The kernel makes that explicit: it walks the row in
+ * blocks of KNAPSACK_BLOCK from the top, first copies value + row[w - weight] for the whole
+ * block into a local array (all reads below the block or inside it, all still old), then takes
+ * the max into the block. Both loops have a constant trip count and no aliasing, so each one
+ * becomes a handful of vector instructions.
+ *
+ * The kernels are built for int32 and int64 profits and dispatched through SimdKernel.
+ *
+ * Two more kernels serve threads that share one item, each on its own range of the capacity,
+ * where the entries below a range belong to a neighbour that may already be rewriting them. One
+ * is the same update taking row[w - weight] from a separate copy of the old entries; the other
+ * is the subset-sum update on a bitset (bit s set when some bricks weigh exactly s), which ORs
+ * the old set shifted by the weight into a new one, 64 sums per word.
+*/
+
+#ifndef KNAPSACK_KNAPSACK_KERNELS_H
+#define KNAPSACK_KNAPSACK_KERNELS_H
+
+#include <cstdint>
+#include <type_traits>
+
+#include "../../Common/cpuFeatures.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define KNAPSACK_KERNEL_INLINE inline __attribute__((always_inline))
+#else
+#define KNAPSACK_KERNEL_INLINE inline
+#endif
+
+// Entries of the row updated per block: a few AVX-512 registers' worth, so the copy stays in L1
+const int KNAPSACK_BLOCK = 64;
+
+//row[w] = max(row[w], value + row[w - weight]) for w = capacity down to weight (weight >= 0)
+template <typename Profit>
+KNAPSACK_KERNEL_INLINE void knapsackItemBody(Profit* row, int capacity, Profit value, int weight) {
+    const int B = KNAPSACK_BLOCK;
+    int end = capacity + 1; // Entries [end, capacity] are already updated
+    while (end - B >= weight) {
+        Profit* block = row + (end - B);
+        const Profit* source = block - weight;
+        Profit taken[KNAPSACK_BLOCK];
+        for (int j = 0; j < B; ++j) taken[j] = value + source[j];
+        for (int j = 0; j < B; ++j) block[j] = taken[j] > block[j] ? taken[j] : block[j];
+        end -= B;
+    }
+    for (int w = end - 1; w >= weight; --w) {
+        Profit candidate = value + row[w - weight];
+        if (candidate > row[w]) row[w] = candidate;
+    }
+}
+
+//The same update as one plain loop, for 64-bit profits without SIMD: plain x86-64 has no 64-bit
+//vector compare, so the blocks would only add the copy
+template <typename Profit>
+KNAPSACK_KERNEL_INLINE void knapsackItemLoop(Profit* row, int capacity, Profit value, int weight) {
+    for (int w = capacity; w >= weight; --w) {
+        Profit candidate = value + row[w - weight];
+        if (candidate > row[w]) row[w] = candidate;
+    }
+}
+
+template <typename Profit>
+using KnapsackItemKernel = void (*)(Profit*, int, Profit, int);
+
+//Row update for int32_t or int64_t profits on this machine
+template <typename Profit>
+KnapsackItemKernel<Profit> selectKnapsackKernel() {
+    static_assert(std::is_same<Profit, int32_t>::value || std::is_same<Profit, int64_t>::value,
+                  "Knapsack profits are int32_t or int64_t");
+    constexpr KnapsackItemKernel<Profit> scalar = sizeof(Profit) == 8 ? knapsackItemLoop<Profit> : knapsackItemBody<Profit>;
+    return SimdKernel<knapsackItemBody<Profit>, scalar>::select();
+}
+
+//row[w] = max(row[w], value + old[w - weight]) for w in [first, last), first >= weight
+template <typename Profit>
+KNAPSACK_KERNEL_INLINE void knapsackRangeBody(const Profit* __restrict old, Profit* __restrict row, int first, int last,
+                                              Profit value, int weight) {
+    for (int w = first; w < last; ++w) {
+        Profit candidate = value + old[w - weight];
+        row[w] = candidate > row[w] ? candidate : row[w];
+    }
+}
+
+template <typename Profit>
+using KnapsackRangeKernel = void (*)(const Profit*, Profit*, int, int, Profit, int);
+
+template <typename Profit>
+KnapsackRangeKernel<Profit> selectKnapsackRangeKernel() {
+    static_assert(std::is_same<Profit, int32_t>::value || std::is_same<Profit, int64_t>::value,
+                  "Knapsack profits are int32_t or int64_t");
+    return SimdKernel<knapsackRangeBody<Profit>>::select();
+}
+
+//target = source | (source << weight) on the words [first, last) of a bitset
+KNAPSACK_KERNEL_INLINE void subsetSumRangeBody(const uint64_t* __restrict source, uint64_t* __restrict target, int first,
+                                               int last, int weight) {
+    const int q = weight / 64, r = weight % 64;
+    //Below word q nothing moves in; word q only gets the low word shifted up
+    int w = first;
+    for (; w < last && w < q; ++w) target[w] = source[w];
+    if (w < last && w == q) {
+        target[w] = source[w] | (source[0] << r);
+        ++w;
+    }
+    //(x >> (63 - r)) >> 1 is x >> (64 - r), and 0 rather than undefined when r is 0
+    for (; w < last; ++w) target[w] = source[w] | (source[w - q] << r) | ((source[w - q - 1] >> (63 - r)) >> 1);
+}
+
+using SubsetSumRangeKernel = void (*)(const uint64_t*, uint64_t*, int, int, int);
+
+inline SubsetSumRangeKernel selectSubsetSumRangeKernel() {
+    return SimdKernel<subsetSumRangeBody>::select();
+}
+
+#endif
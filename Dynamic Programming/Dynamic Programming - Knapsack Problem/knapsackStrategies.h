@@ -0,0 +1,286 @@
+/**
+ * Front end for 0/1 knapsacks the weight-indexed table of knapsack.h cannot hold, like a
+ * capacity around 1e9. It looks at the bricks that can matter and picks the cheapest of:
+ *
+ *  - the weight table of knapsack(): O(n C) with C the capacity (or the total weight, if less),
+ *    or O(n C / 64) when it is subset sum
+ *  - the profit table: minWeight[p], the least weight that makes a profit of exactly p, in
+ *    O(n P) with P the total profit, so it does not care how large the weights are
+ *  - meet in the middle for n <= 40: every subset of each half, sorted by weight with the
+ *    dominated ones dropped, then one sweep over both lists in O(2^(n/2))
+ *  - branch and bound, depth first over the bricks by profit per weight, cut with the bound of
+ *    the LP relaxation (Dantzig's: the greedy prefix plus a fraction of the next brick).
+ *
+ * The first three are exact. Branch and bound runs under a time budget; when the budget runs
+ * out it returns the best selection found together with the largest bound still open, so the
+ * optimum is proven to lie between the two.
+*/
+
+#ifndef KNAPSACK_KNAPSACK_STRATEGIES_H
+#define KNAPSACK_KNAPSACK_STRATEGIES_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "knapsack.h"
+
+enum class KnapsackStrategy { WeightTable, ProfitTable, MeetInTheMiddle, BranchAndBound };
+
+inline const char* knapsackStrategyName(KnapsackStrategy strategy) {
+    switch (strategy) {
+        case KnapsackStrategy::WeightTable: return "weight-indexed table";
+        case KnapsackStrategy::ProfitTable: return "profit-indexed table";
+        case KnapsackStrategy::MeetInTheMiddle: return "meet in the middle";
+        default: return "branch and bound";
+    }
+}
+
+// Largest table (entries) the exact strategies may allocate: 1 GB of int64_t
+const int64_t KNAPSACK_MAX_TABLE = int64_t(1) << 27;
+// Most row updates (or subsets) an exact strategy may take before branch and bound is preferred
+const double KNAPSACK_MAX_STEPS = 2e10;
+// Most bricks meet in the middle enumerates the subsets of
+const int KNAPSACK_MAX_MITM_BRICKS = 40;
+// Time budget of branch and bound, in seconds
+const double KNAPSACK_DEFAULT_SECONDS = 10.0;
+
+struct KnapsackAnswer {
+    int64_t profit = 0; // Profit of the best selection found
+    int64_t bound = 0;  // Proven upper bound on the optimum; equal to profit when it was solved exactly
+    KnapsackStrategy strategy = KnapsackStrategy::WeightTable;
+    bool selected = false; // The bricks of the selection were listed (see adaptiveKnapsack)
+    bool optimal() const { return profit == bound; }
+};
+
+//The bricks that can be part of a best selection within 'capacity': a positive value and a weight
+//from 1 to capacity. Weightless bricks with a value are always taken, so their values go to 'base'.
+//'indices', if given, receives the position in 'bricks' of every useful brick.
+inline std::vector<std::pair<int, int>> usefulKnapsackBricks(int64_t capacity, const std::vector<std::pair<int, int>>& bricks,
+                                                             int64_t& base, std::vector<int>* indices = nullptr) {
+    std::vector<std::pair<int, int>> useful;
+    base = 0;
+    if (indices != nullptr) indices->clear();
+    for (size_t i = 0; i < bricks.size(); ++i) {
+        const std::pair<int, int>& brick = bricks[i];
+        if (brick.first <= 0 || brick.second > capacity) continue;
+        if (brick.second <= 0) {
+            base += brick.first;
+        } else {
+            useful.push_back(brick);
+            if (indices != nullptr) indices->push_back((int)i);
+        }
+    }
+    return useful;
+}
+
+//Picks the strategy for the useful bricks (see usefulKnapsackBricks) within 'capacity'
+inline KnapsackStrategy chooseKnapsackStrategy(int64_t capacity, const std::vector<std::pair<int, int>>& useful) {
+    int64_t totalWeight = 0, totalProfit = 0;
+    for (const std::pair<int, int>& brick : useful) {
+        totalWeight += brick.second;
+        totalProfit += brick.first;
+    }
+    double n = (double)useful.size();
+    int64_t columns = std::min(capacity, totalWeight);
+
+    KnapsackStrategy best = KnapsackStrategy::BranchAndBound;
+    double bestSteps = KNAPSACK_MAX_STEPS;
+    auto consider = [&](KnapsackStrategy strategy, double steps) {
+        if (steps <= bestSteps) {
+            best = strategy;
+            bestSteps = steps;
+        }
+    };
+    if (useful.size() <= (size_t)KNAPSACK_MAX_MITM_BRICKS) {
+        // Both halves are merged brick by brick and swept once: a few passes over 2^(n/2) subsets
+        consider(KnapsackStrategy::MeetInTheMiddle, 4 * std::ldexp(1.0, (int)(useful.size() + 1) / 2));
+    }
+    if (totalProfit <= KNAPSACK_MAX_TABLE) consider(KnapsackStrategy::ProfitTable, n * (double)totalProfit);
+    // Subset sum keeps 64 weights per word of its bitset
+    int64_t perEntry = knapsackIsSubsetSum(useful) ? 64 : 1;
+    if (columns <= KNAPSACK_MAX_TABLE * perEntry && columns <= INT32_MAX) {
+        consider(KnapsackStrategy::WeightTable, n * (double)columns / perEntry);
+    }
+    return best;
+}
+
+//Maximum profit of the useful bricks within 'capacity' from the least weight of every total profit
+inline int64_t knapsackByProfit(int64_t capacity, const std::vector<std::pair<int, int>>& useful) {
+    int64_t totalProfit = 0;
+    for (const std::pair<int, int>& brick : useful) totalProfit += brick.first;
+    //row[p] = -(least weight with profit exactly p), so that adding a brick is the max-plus update
+    //of the 0/1 knapsack with the roles of value and weight swapped
+    const int64_t UNREACHABLE = INT64_MIN / 4;
+    std::vector<int64_t> row(totalProfit + 1, UNREACHABLE);
+    row[0] = 0;
+    KnapsackItemKernel<int64_t> relax = selectKnapsackKernel<int64_t>();
+    for (const std::pair<int, int>& brick : useful) relax(row.data(), (int)totalProfit, -(int64_t)brick.second, brick.first);
+    for (int64_t p = totalProfit; p > 0; --p) {
+        if (row[p] > UNREACHABLE / 2 && -row[p] <= capacity) return p;
+    }
+    return 0;
+}
+
+//Every selection of useful[first, last) within 'capacity' as (weight, profit), sorted by weight,
+//keeping only those more profitable than every lighter one
+inline void knapsackSubsets(int64_t capacity, const std::vector<std::pair<int, int>>& useful, size_t first, size_t last,
+                            std::vector<std::pair<int64_t, int64_t>>& subsets) {
+    subsets.assign(1, {0, 0});
+    std::vector<std::pair<int64_t, int64_t>> merged;
+    for (size_t i = first; i < last; ++i) {
+        int64_t value = useful[i].first, weight = useful[i].second;
+        //Merges the selections without brick i and the same ones with it, both sorted by weight
+        merged.clear();
+        size_t a = 0, b = 0;
+        while (a < subsets.size() || (b < subsets.size() && subsets[b].first + weight <= capacity)) {
+            std::pair<int64_t, int64_t> next;
+            if (b < subsets.size() && subsets[b].first + weight <= capacity &&
+                (a == subsets.size() || subsets[b].first + weight < subsets[a].first)) {
+                next = {subsets[b].first + weight, subsets[b].second + value};
+                ++b;
+            } else {
+                next = subsets[a++];
+            }
+            if (merged.empty() || next.second > merged.back().second) {
+                if (!merged.empty() && merged.back().first == next.first) merged.back() = next;
+                else merged.push_back(next);
+            }
+        }
+        subsets.swap(merged);
+    }
+}
+
+//Maximum profit of at most KNAPSACK_MAX_MITM_BRICKS useful bricks within 'capacity'
+inline int64_t knapsackMeetInTheMiddle(int64_t capacity, const std::vector<std::pair<int, int>>& useful) {
+    std::vector<std::pair<int64_t, int64_t>> left, right;
+    size_t middle = useful.size() / 2;
+    knapsackSubsets(capacity, useful, 0, middle, left);
+    knapsackSubsets(capacity, useful, middle, useful.size(), right);
+    //Profits grow with the weights in both lists, so the best partner of each left selection is the
+    //heaviest right one that still fits, which only gets lighter as the left ones get heavier
+    int64_t best = 0;
+    size_t j = right.size();
+    for (const std::pair<int64_t, int64_t>& selection : left) {
+        while (j > 0 && selection.first + right[j - 1].first > capacity) --j;
+        if (j == 0) break;
+        best = std::max(best, selection.second + right[j - 1].second);
+    }
+    return best;
+}
+
+/**
+ * @brief Branch and bound over the useful bricks within 'capacity', stopping after 'seconds'.
+ * The bricks are sorted by profit per weight; a node fixes the first 'level' of them, and its
+ * bound is the LP relaxation of the rest: the bricks that fit in the remaining capacity in that
+ * order, plus the fitting fraction of the first one that does not. The greedy prefix is itself a
+ * selection, which keeps the incumbent good from the first node on. The search goes depth first,
+ * taking a brick before leaving it, and drops every node whose bound does not beat the incumbent.
+ */
+inline KnapsackAnswer knapsackBranchAndBound(int64_t capacity, std::vector<std::pair<int, int>> useful,
+                                             double seconds = KNAPSACK_DEFAULT_SECONDS) {
+    std::sort(useful.begin(), useful.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return (int64_t)a.first * b.second > (int64_t)b.first * a.second;
+    });
+    size_t n = useful.size();
+    std::vector<int64_t> weights(n + 1, 0), profits(n + 1, 0); // Prefix sums
+    for (size_t i = 0; i < n; ++i) {
+        weights[i + 1] = weights[i] + useful[i].second;
+        profits[i + 1] = profits[i] + useful[i].first;
+    }
+
+    KnapsackAnswer answer;
+    answer.strategy = KnapsackStrategy::BranchAndBound;
+    //Bound of the node that fixed the first 'level' bricks at (weight, profit); also raises the incumbent
+    auto bound = [&](size_t level, int64_t weight, int64_t profit) {
+        int64_t room = capacity - weight;
+        size_t critical = std::upper_bound(weights.begin() + level, weights.end(), weights[level] + room) - weights.begin() - 1;
+        int64_t greedy = profit + profits[critical] - profits[level];
+        answer.profit = std::max(answer.profit, greedy);
+        if (critical == n) return greedy;
+        room -= weights[critical] - weights[level];
+        return greedy + room * useful[critical].first / useful[critical].second;
+    };
+
+    struct Node {
+        size_t level;
+        int64_t weight, profit, bound;
+    };
+    std::vector<Node> stack = {{0, 0, 0, bound(0, 0, 0)}};
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+    for (size_t visited = 0; !stack.empty(); ++visited) {
+        if (visited % 4096 == 0 && std::chrono::steady_clock::now() > deadline) break;
+        Node node = stack.back();
+        stack.pop_back();
+        if (node.bound <= answer.profit || node.level == n) continue;
+        int64_t leave = bound(node.level + 1, node.weight, node.profit);
+        if (leave > answer.profit) stack.push_back({node.level + 1, node.weight, node.profit, leave});
+        int64_t weight = node.weight + useful[node.level].second;
+        if (weight <= capacity) {
+            int64_t profit = node.profit + useful[node.level].first;
+            int64_t take = bound(node.level + 1, weight, profit);
+            if (take > answer.profit) stack.push_back({node.level + 1, weight, profit, take});
+        }
+    }
+
+    //Whatever is left on the stack was not ruled out, so the optimum is at most its best bound
+    answer.bound = answer.profit;
+    for (const Node& node : stack) answer.bound = std::max(answer.bound, node.bound);
+    return answer;
+}
+
+//Maximum profit of the 0/1 knapsack by the strategy that suits the bricks (see the top of this file);
+//only branch and bound uses 'seconds', and only then may the answer fall short of the bound.
+//'threads' split the rows of the weight table. When the weight table is used and 'taken' is given,
+//it is solved by knapsackSelection() instead and 'taken' receives the indices (in increasing order)
+//of the bricks the best selection takes; the profit is their sum, so the table is solved only once.
+//Subset sum is the exception once its rows outgrow KNAPSACK_MAX_TABLE: the strategy was only
+//affordable because of the bitset, which cannot trace the bricks back, so 'taken' stays empty
+//and 'selected' false.
+inline KnapsackAnswer adaptiveKnapsack(int64_t capacity, const std::vector<std::pair<int, int>>& bricks,
+                                       double seconds = KNAPSACK_DEFAULT_SECONDS, unsigned threads = 1,
+                                       std::vector<int>* taken = nullptr) {
+    int64_t base = 0;
+    std::vector<int> indices;
+    std::vector<std::pair<int, int>> useful = usefulKnapsackBricks(capacity, bricks, base, taken != nullptr ? &indices : nullptr);
+    KnapsackAnswer answer;
+    answer.strategy = chooseKnapsackStrategy(capacity, useful);
+    if (taken != nullptr) taken->clear();
+    switch (answer.strategy) {
+        case KnapsackStrategy::WeightTable: {
+            int64_t totalWeight = 0;
+            for (const std::pair<int, int>& brick : useful) totalWeight += brick.second;
+            int columns = (int)std::min(capacity, totalWeight);
+            bool wide = knapsackNeedsInt64(columns, useful);
+            if (taken == nullptr || (knapsackIsSubsetSum(useful) && columns > KNAPSACK_MAX_TABLE)) {
+                answer.profit = wide ? knapsack<int64_t>(columns, useful, threads) : knapsack(columns, useful, threads);
+                break;
+            }
+            std::vector<int> chosen = wide ? knapsackSelection<int64_t>(columns, useful, threads)
+                                           : knapsackSelection(columns, useful, threads);
+            //The weightless bricks with a value are part of every best selection
+            for (size_t i = 0; i < bricks.size(); ++i) {
+                if (bricks[i].first > 0 && bricks[i].second <= 0) taken->push_back((int)i);
+            }
+            for (int brick : chosen) {
+                answer.profit += useful[brick].first;
+                taken->push_back(indices[brick]);
+            }
+            std::sort(taken->begin(), taken->end());
+            answer.selected = true;
+            break;
+        }
+        case KnapsackStrategy::ProfitTable: answer.profit = knapsackByProfit(capacity, useful); break;
+        case KnapsackStrategy::MeetInTheMiddle: answer.profit = knapsackMeetInTheMiddle(capacity, useful); break;
+        case KnapsackStrategy::BranchAndBound: answer = knapsackBranchAndBound(capacity, useful, seconds); break;
+    }
+    if (answer.strategy != KnapsackStrategy::BranchAndBound) answer.bound = answer.profit;
+    answer.profit += base;
+    answer.bound += base;
+    return answer;
+}
+
+#endif
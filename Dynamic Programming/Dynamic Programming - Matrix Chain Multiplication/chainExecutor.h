@@ -0,0 +1,293 @@
+/**
+ * The optimal bracketing of a matrix chain as an expression tree, and an executor that
+ * multiplies a chain of real matrices in that order with the Strassen engine.
+ *
+ * planChainOrder() runs the tiled dynamic program of chainTable.h and reads the tree back from
+ * its split table. multiplyChain() walks the tree: independent subtrees run as tasks on a
+ * work-stealing pool, every product goes through the engine's serial recursion or the serial
+ * blocked kernel (a product that runs alone uses the parallel recursion or splits into row bands
+ * on the pool: the root, and every product on a path where no sibling became a task, like all
+ * of a left-deep chain), and the buffers of intermediate products and the
+ * engine workspaces are handed back to a free list as soon as they have been consumed, so a
+ * long chain allocates roughly what its largest concurrently live products need.
+*/
+
+#ifndef MCM_CHAIN_EXECUTOR_H
+#define MCM_CHAIN_EXECUTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "../../Common/threadPool.h"
+#include "../../Divide and Conquer/Strassen's Algorithm/strassen.h"
+#include "chainTable.h"
+
+// Subtrees cheaper than this many scalar multiplications are evaluated on the thread that reaches them
+const long long CHAIN_TASK_MIN_COST = 1 << 20;
+
+// --- Expression Tree ---
+
+/**
+ * @brief One node of the bracketing: the product of matrices first..last (0-based, inclusive),
+ * formed from two operand nodes, or a single matrix when left == right == -1.
+ */
+struct ChainNode {
+    int first = 0;
+    int last = 0;
+    int left = -1;
+    int right = -1;
+    long long cost = 0; // Scalar multiplications needed for this sub-product
+};
+
+/**
+ * @brief Optimal order for a chain: its cost and its expression tree, nodes[0] being the root.
+ */
+struct ChainPlan {
+    long long cost = 0;
+    std::vector<ChainNode> nodes;
+
+    int matrices() const { return nodes.empty() ? 0 : nodes[0].last + 1; }
+};
+
+//Reads the expression tree of the whole chain back from a solved table: any table over 'vertices'
+//polygon vertices with at(i, j) and splitAt(i, j), like ChainTable and IncrementalChainOrder
+template <typename Table>
+ChainPlan planFromTable(const Table &table, int vertices) {
+    ChainPlan plan;
+    if (vertices < 2) return plan;
+    plan.nodes.push_back({0, vertices - 2, -1, -1, 0});
+    for (size_t index = 0; index < plan.nodes.size(); ++index) {
+        ChainNode node = plan.nodes[index];
+        if (node.first == node.last) continue;
+        // Matrices first..last are vertices first..last + 1 of the polygon
+        node.cost = table.at(node.first, node.last + 1);
+        int k = table.splitAt(node.first, node.last + 1);
+        node.left = (int)plan.nodes.size();
+        node.right = node.left + 1;
+        plan.nodes.push_back({node.first, k - 1, -1, -1, 0});
+        plan.nodes.push_back({k, node.last, -1, -1, 0});
+        plan.nodes[index] = node;
+    }
+    plan.cost = plan.nodes[0].cost;
+    return plan;
+}
+
+//Optimal order for the chain with dimensions P (matrix i is P[i-1] x P[i]), planned on 'threads' threads
+inline ChainPlan planChainOrder(const std::vector<int> &P, unsigned threads = 1) {
+    ChainTable table = solveChainTable(P, threads);
+    return planFromTable(table, table.vertices);
+}
+
+//The bracketing as text, e.g. "((M1M2)M3)", numbering matrices from 1
+inline std::string chainParenthesization(const ChainPlan &plan) {
+    std::string text;
+    if (plan.nodes.empty()) return text;
+    // Explicit stack of pending pieces: a node to expand or a closing bracket to emit
+    std::vector<int> pending{0};
+    while (!pending.empty()) {
+        int index = pending.back();
+        pending.pop_back();
+        if (index < 0) {
+            text += ')';
+            continue;
+        }
+        const ChainNode &node = plan.nodes[index];
+        if (node.left < 0) {
+            text += "M" + std::to_string(node.first + 1);
+            continue;
+        }
+        text += '(';
+        pending.push_back(-1);
+        pending.push_back(node.right);
+        pending.push_back(node.left);
+    }
+    return text;
+}
+
+// --- Chain Executor ---
+
+/**
+ * @brief Evaluates one plan over one chain. Not meant to be used directly; see multiplyChain().
+ */
+template <typename T>
+class ChainExecutor {
+public:
+    using R = ResultType<T>;
+
+    ChainExecutor(const std::vector<Matrix<T>> &matrices, const ChainPlan &chainPlan, const StrassenOptions &options,
+                  ThreadPool* threadPool)
+        : chain(matrices), plan(chainPlan), settings(options), pool(threadPool) {
+        if (settings.cutoff <= 0) settings.cutoff = DEFAULT_STRASSEN_CUTOFF;
+        settings.cutoff = std::max(settings.cutoff, 1);
+    }
+
+    Matrix<R> run() {
+        Operand product = evaluate(0, true);
+        Matrix<R> result;
+        result.rows = product.view.rows;
+        result.cols = product.view.cols;
+        if (product.storage.empty()) {
+            // A one-matrix chain: the product is the matrix itself
+            result.data.assign(product.view.data, product.view.data + (size_t)result.rows * result.cols);
+        } else {
+            result.data = std::move(product.storage);
+            result.data.resize((size_t)result.rows * result.cols);
+        }
+        return result;
+    }
+
+private:
+    // A node's value: a view of an input matrix, or of a buffer the executor owns
+    struct Operand {
+        ConstMatrixView<R> view;
+        std::vector<R> storage;
+    };
+
+    const std::vector<Matrix<T>> &chain;
+    const ChainPlan &plan;
+    StrassenOptions settings;
+    ThreadPool* pool;
+
+    std::mutex freeMutex;
+    std::vector<std::vector<R>> freeBuffers;
+    std::vector<StrassenWorkspace<R>> freeWorkspaces;
+
+    //Smallest free buffer that holds 'elements', or a new one
+    std::vector<R> acquireBuffer(size_t elements) {
+        {
+            std::lock_guard<std::mutex> lock(freeMutex);
+            int best = -1;
+            for (int i = 0; i < (int)freeBuffers.size(); ++i) {
+                if (freeBuffers[i].capacity() >= elements &&
+                    (best < 0 || freeBuffers[i].capacity() < freeBuffers[best].capacity())) {
+                    best = i;
+                }
+            }
+            if (best >= 0) {
+                std::vector<R> buffer = std::move(freeBuffers[best]);
+                freeBuffers.erase(freeBuffers.begin() + best);
+                buffer.resize(elements);
+                return buffer;
+            }
+        }
+        return std::vector<R>(elements);
+    }
+
+    void releaseBuffer(std::vector<R> &buffer) {
+        if (buffer.capacity() == 0) return;
+        std::lock_guard<std::mutex> lock(freeMutex);
+        freeBuffers.push_back(std::move(buffer));
+    }
+
+    StrassenWorkspace<R> acquireWorkspace() {
+        std::lock_guard<std::mutex> lock(freeMutex);
+        if (freeWorkspaces.empty()) return StrassenWorkspace<R>();
+        StrassenWorkspace<R> workspace = std::move(freeWorkspaces.back());
+        freeWorkspaces.pop_back();
+        return workspace;
+    }
+
+    void releaseWorkspace(StrassenWorkspace<R> &workspace) {
+        std::lock_guard<std::mutex> lock(freeMutex);
+        freeWorkspaces.push_back(std::move(workspace));
+    }
+
+    //Value of node 'index'; 'alone' means nothing else runs while this subtree is evaluated
+    Operand evaluate(int index, bool alone) {
+        const ChainNode &node = plan.nodes[index];
+        Operand result;
+        if (node.left < 0) {
+            const Matrix<T> &matrix = chain[node.first];
+            if constexpr (std::is_same<T, R>::value) {
+                result.view = matrix.view();
+            } else {
+                // int32 inputs are widened once, as the engine does
+                result.storage = acquireBuffer(matrix.data.size());
+                std::copy(matrix.data.begin(), matrix.data.end(), result.storage.begin());
+                result.view = {result.storage.data(), matrix.rows, matrix.cols, matrix.cols};
+            }
+            return result;
+        }
+
+        Operand left, right;
+        const ChainNode &leftNode = plan.nodes[node.left], &rightNode = plan.nodes[node.right];
+        if (pool != nullptr && std::min(leftNode.cost, rightNode.cost) >= CHAIN_TASK_MIN_COST) {
+            TaskGroup group(*pool);
+            group.run([&] { left = evaluate(node.left, false); });
+            right = evaluate(node.right, false);
+            group.wait();
+        } else {
+            // One after the other, so each side is alone exactly when this node is
+            left = evaluate(node.left, alone);
+            right = evaluate(node.right, alone);
+        }
+
+        int m = left.view.rows, n = right.view.cols;
+        result.storage = acquireBuffer((size_t)m * n);
+        MatrixView<R> product{result.storage.data(), m, n, n};
+        multiply(left.view, right.view, product, alone);
+        result.view = product;
+        releaseBuffer(left.storage);
+        releaseBuffer(right.storage);
+        return result;
+    }
+
+    //product = A * B with the configured algorithm; 'alone' means no other product is running
+    void multiply(ConstMatrixView<R> A, ConstMatrixView<R> B, MatrixView<R> product, bool alone) {
+        if (settings.algorithm == MultiplyAlgorithm::Classic) {
+            // Alone, the product's row bands spread over the idle pool
+            blockedMultiplyOn(A, B, product, alone ? pool : nullptr);
+            return;
+        }
+        int m = product.rows, k = A.cols, n = product.cols;
+        StrassenWorkspace<R> workspace = acquireWorkspace();
+        if (alone && pool != nullptr) {
+            int depth = settings.parallelDepth >= 0 ? settings.parallelDepth : defaultParallelDepth(settings.threads);
+            workspace.reserve(strassenParallelWorkspaceSize(m, k, n, depth, settings));
+            strassenMultiplyParallel(A, B, product, workspace, *pool, depth, settings);
+        } else {
+            workspace.reserve(strassenWorkspaceSize(m, k, n, settings.cutoff));
+            serialMultiplyRecursive(A, B, product, workspace, settings.algorithm, settings.cutoff);
+        }
+        releaseWorkspace(workspace);
+    }
+};
+
+/**
+ * @brief Multiplies chain[0] * chain[1] * ... in the order given by 'plan', on options.threads
+ * threads with options.algorithm and options.cutoff for every product. Throws when the chain
+ * does not match the plan or two neighbouring matrices cannot be multiplied.
+ */
+template <typename T>
+Matrix<ResultType<T>> multiplyChain(const std::vector<Matrix<T>> &chain, const ChainPlan &plan,
+                                    const StrassenOptions &options = StrassenOptions()) {
+    if (chain.empty() || (int)chain.size() != plan.matrices()) {
+        throw std::runtime_error("Error: The plan is for " + std::to_string(plan.matrices()) + " matrices but the chain has " +
+                                 std::to_string(chain.size()) + ".");
+    }
+    for (size_t i = 0; i + 1 < chain.size(); ++i) {
+        if (chain[i].cols != chain[i + 1].rows) {
+            throw std::runtime_error("Error: Matrix " + std::to_string(i + 1) + " has " + std::to_string(chain[i].cols) +
+                                     " columns but matrix " + std::to_string(i + 2) + " has " +
+                                     std::to_string(chain[i + 1].rows) + " rows.");
+        }
+    }
+    std::unique_ptr<ThreadPool> pool = helperPool(options.threads);
+    return ChainExecutor<T>(chain, plan, options, pool.get()).run();
+}
+
+//Same, planning the optimal order first
+template <typename T>
+Matrix<ResultType<T>> multiplyChain(const std::vector<Matrix<T>> &chain, const StrassenOptions &options = StrassenOptions()) {
+    std::vector<int> P;
+    for (const Matrix<T> &matrix : chain) P.push_back(matrix.rows);
+    if (!chain.empty()) P.push_back(chain.back().cols);
+    return multiplyChain(chain, planChainOrder(P, options.threads), options);
+}
+
+#endif
@@ -0,0 +1,188 @@
+/**
+ * Packed, tiled cost table for the O(n^3) matrix-chain dynamic program.
+ *
+ * In polygon form, cost(i, j) for 0 <= i < j < P.size() is the cheapest way to multiply
+ * matrices i..j-1 (matrix m is P[m] x P[m+1]):
+ *   cost(i, i + 1) = 0,   cost(i, j) = min over i < k < j of cost(i, k) + cost(k, j) + P[i] P[k] P[j]
+ * Cell (i, j) needs row i to its left and column j below it, so the classic layout reads one of
+ * them down a column and streams the whole table through the cache for every diagonal.
+ *
+ * Here the table is cut into CHAIN_TILE x CHAIN_TILE tiles and only tiles on or above the
+ * diagonal are stored, packed diagonal by diagonal. For a cell of tile (I, J), the splits k
+ * that fall in a tile K strictly between I and J only read the finished tiles (I, K) and
+ * (K, J); for all cells of the tile at once that is a min-plus product of two tiles, done as
+ *   row i of (I, J) = min(row i of (I, J), cost(i, k) + row k of (K, J) + P[i] P[k] P[j..])
+ * for every k: a unit-stride, element-wise min over a row that sits in registers, which the
+ * compiler vectorizes. Splits inside tile I or tile J need the tile itself and are swept row
+ * by row (bottom-up) and split by split (left to right) so each one only reads finished cells.
+ * All tiles on one tile diagonal are independent, so a diagonal is one parallel step.
+ *
+ * Next to every cost the table keeps the split that achieves it, in the same layout, so the
+ * optimal bracketing can be read back (see chainExecutor.h).
+*/
+
+#ifndef MCM_CHAIN_TABLE_H
+#define MCM_CHAIN_TABLE_H
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+#include "../../Common/cpuFeatures.h"
+#include "../../Common/threadPool.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CHAIN_KERNEL_INLINE inline __attribute__((always_inline))
+#else
+#define CHAIN_KERNEL_INLINE inline
+#endif
+
+// Tile edge: one row of a tile is 8 AVX-512 registers, and the three tiles of a product fit in L2
+const int CHAIN_TILE = 64;
+// Tile diagonals with fewer tile products than this run on the calling thread
+const int CHAIN_PARALLEL_PRODUCTS = 8;
+
+/**
+ * @brief Minimum cost of every sub-chain in polygon form, cost(i, j) for i < j, stored as
+ * CHAIN_TILE x CHAIN_TILE row-major tiles on and above the diagonal, one tile diagonal after
+ * another.
+ */
+struct ChainTable {
+    int vertices = 0;  // P.size()
+    int tiles = 0;     // Tiles per side
+    std::vector<long long> cost;
+    std::vector<int> split; // Best k for each cell, laid out like 'cost'
+
+    //Offset of tile (I, J), I <= J: tile diagonal d = J - I starts after the d * tiles - d (d - 1) / 2 tiles before it
+    size_t tileOffset(int I, int J) const {
+        size_t d = J - I;
+        return (d * tiles - d * (d - 1) / 2 + I) * CHAIN_TILE * CHAIN_TILE;
+    }
+    long long* tile(int I, int J) { return cost.data() + tileOffset(I, J); }
+    const long long* tile(int I, int J) const { return cost.data() + tileOffset(I, J); }
+    int* splitTile(int I, int J) { return split.data() + tileOffset(I, J); }
+
+    size_t cellOffset(int i, int j) const {
+        return tileOffset(i / CHAIN_TILE, j / CHAIN_TILE) + (i % CHAIN_TILE) * CHAIN_TILE + j % CHAIN_TILE;
+    }
+
+    //Cheapest way to multiply matrices i..j-1
+    long long at(int i, int j) const { return cost[cellOffset(i, j)]; }
+
+    //Split k of that cheapest way, (M_i..M_{k-1}) * (M_k..M_{j-1}); only meaningful for j > i + 1
+    int splitAt(int i, int j) const { return split[cellOffset(i, j)]; }
+};
+
+// --- Tile Kernels ---
+
+//row[j] = min(row[j], a + source[j] + c * dims[j]) for j in [from, to), recording split k where it improves
+CHAIN_KERNEL_INLINE void relaxRow(long long* __restrict row, int* __restrict rowSplit, long long a, long long c,
+                                  const long long* __restrict source, const long long* __restrict dims, int k,
+                                  int from, int to) {
+    for (int j = from; j < to; ++j) {
+        long long candidate = a + source[j] + c * dims[j];
+        bool better = candidate < row[j];
+        row[j] = better ? candidate : row[j];
+        rowSplit[j] = better ? k : rowSplit[j];
+    }
+}
+
+/**
+ * @brief Fills tile (I, J). 'dims' is P widened to long long and padded to a whole number of
+ * tiles.
+ */
+CHAIN_KERNEL_INLINE void chainTileBody(ChainTable &table, const long long* dims, int I, int J) {
+    const int T = CHAIN_TILE;
+    long long* out = table.tile(I, J);
+    int* outSplit = table.splitTile(I, J);
+    const long long* rowDims = dims + I * T;
+    const long long* colDims = dims + J * T;
+    const long long* lower = table.tile(I, I);  // Splits inside tile I
+    const long long* upper = table.tile(J, J);  // Splits inside tile J
+    const bool diagonal = I == J;
+
+    for (int i = T - 1; i >= 0; --i) {
+        const int gi = I * T + i;
+        long long row[CHAIN_TILE];
+        int rowSplit[CHAIN_TILE];
+        for (int j = 0; j < T; ++j) {
+            row[j] = J * T + j == gi + 1 ? 0 : LLONG_MAX;
+            rowSplit[j] = gi;
+        }
+
+        // Splits in the tiles strictly between I and J: the whole row, one finished tile pair at a time
+        for (int K = I + 1; K < J; ++K) {
+            const long long* left = table.tile(I, K) + i * T;
+            const long long* right = table.tile(K, J);
+            const long long* splitDims = dims + K * T;
+            for (int k = 0; k < T; ++k) {
+                relaxRow(row, rowSplit, left[k], rowDims[i] * splitDims[k], right + k * T, colDims, K * T + k, 0, T);
+            }
+        }
+        // Splits in tile I below row i, whose rows of this tile are already finished
+        if (!diagonal) {
+            for (int k = i + 1; k < T; ++k) {
+                relaxRow(row, rowSplit, lower[i * T + k], rowDims[i] * rowDims[k], out + k * T, colDims, I * T + k, 0, T);
+            }
+        }
+        // Splits in tile J, left to right: row[k] is final by the time split k is used
+        for (int k = diagonal ? i + 1 : 0; k < T; ++k) {
+            relaxRow(row, rowSplit, row[k], rowDims[i] * colDims[k], upper + k * T, colDims, J * T + k, k + 1, T);
+        }
+        std::copy(row, row + T, out + i * T);
+        std::copy(rowSplit, rowSplit + T, outSplit + i * T);
+    }
+}
+
+using ChainTileKernel = void (*)(ChainTable&, const long long*, int, int);
+
+inline ChainTileKernel selectChainTileKernel() {
+    return SimdKernel<chainTileBody>::select();
+}
+
+// --- Wavefront ---
+
+/**
+ * @brief Fills the whole table for dimensions P one tile diagonal at a time. The tiles of a
+ * diagonal run on 'pool' and on the calling thread once they hold enough work to split.
+ */
+inline ChainTable solveChainTable(const std::vector<int> &P, ThreadPool* pool) {
+    ChainTable table;
+    table.vertices = (int)P.size();
+    table.tiles = (table.vertices + CHAIN_TILE - 1) / CHAIN_TILE;
+    const int tiles = table.tiles;
+    table.cost.assign((size_t)tiles * (tiles + 1) / 2 * CHAIN_TILE * CHAIN_TILE, 0);
+    table.split.assign(table.cost.size(), 0);
+    // Padding vertices get dimension 0: their cells are computed but never read
+    std::vector<long long> dims((size_t)tiles * CHAIN_TILE, 0);
+    std::copy(P.begin(), P.end(), dims.begin());
+    ChainTileKernel kernel = selectChainTileKernel();
+
+    for (int d = 0; d < tiles; ++d) {
+        const int count = tiles - d;
+        if (pool == nullptr || count == 1 || (long long)count * std::max(d, 1) < CHAIN_PARALLEL_PRODUCTS) {
+            for (int I = 0; I < count; ++I) kernel(table, dims.data(), I, I + d);
+            continue;
+        }
+        TaskGroup group(*pool);
+        for (int I = 0; I < count; ++I) {
+            group.run([&table, &dims, kernel, I, d] { kernel(table, dims.data(), I, I + d); });
+        }
+        group.wait();
+    }
+    return table;
+}
+
+//Same, on a pool the caller keeps across calls
+inline ChainTable solveChainTable(const std::vector<int> &P, ThreadPool &pool) {
+    return solveChainTable(P, &pool);
+}
+
+//Same, on 'threads' threads in total (1 keeps every diagonal on the calling thread)
+inline ChainTable solveChainTable(const std::vector<int> &P, unsigned threads = 1) {
+    std::unique_ptr<ThreadPool> pool = helperPool(threads);
+    return solveChainTable(P, pool.get());
+}
+
+#endif
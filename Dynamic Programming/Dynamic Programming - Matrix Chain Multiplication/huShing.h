@@ -0,0 +1,295 @@
+/**
+ * Matrix chain ordering for very long chains, after Hu and Shing's polygon-partitioning view.
+ *
+ * A chain with dimensions P[0..n-1] is a convex polygon with vertex weights P[i], and every
+ * bracketing of the chain is a triangulation of it whose cost is the sum over its triangles of
+ * the product of their three weights. Rotate the polygon so that the lightest vertex V0 comes
+ * first. An arc Vi - Vj (i < j) is a potential h-arc when every vertex strictly between them is
+ * heavier than both ends; there are fewer than n of them, they never cross, and one monotone
+ * stack sweep finds them all. Some optimal triangulation consists of a subset of these arcs plus,
+ * inside every region they cut out, the fan from the region's lightest vertex.
+ *
+ * Exact solver: an arc's region is the fan from its lighter end, so whether the arc pays off
+ * depends only on the weight x of the apex fanning over it from outside. The sub-polygon's cost
+ * without the arc is concave and piecewise linear in x, grows faster than x * Vi * Vj, and
+ * crosses "arc kept" at one supporting weight: the arc is kept exactly when x is at least that
+ * weight. Apexes only get lighter further out, so a dropped arc stays dropped. Each arc keeps
+ * the arcs still kept below it in a leftist max-heap on supporting weight together with the
+ * slope and constant of its current linear piece; moving outwards pops the arcs whose weight
+ * exceeds the new apex and merges their heaps in. O(n log n) time and O(n) memory.
+ *
+ * Approximate solver: Hu and Shing's O(n) heuristic. The sweep cuts off the triangle Vi, c, Vj
+ * over each arc's lightest inner vertex c only while the quadrilateral V0, Vi, c, Vj is cheaper
+ * split along Vi - Vj, i.e. while 1/V0 + 1/c < 1/Vi + 1/Vj; whatever is left is fanned from V0.
+ * Their analysis bounds its cost by 2/sqrt(3) (about 1.155) times the optimum.
+ *
+ * Costs are long long, like the dynamic program's; comparisons of supporting weights are exact.
+*/
+
+#ifndef MCM_HU_SHING_H
+#define MCM_HU_SHING_H
+
+#include <utility>
+#include <vector>
+
+// --- Potential h-Arcs ---
+
+/**
+ * @brief Potential h-arcs of the rotated polygon v[0..n], where v[n] is v[0] again. Arcs are
+ * listed children first, so the last one is the root (0, n), i.e. the whole polygon.
+ */
+struct PolygonArcs {
+    std::vector<long long> v;        // Rotated vertex weights, v[n] == v[0]
+    std::vector<long long> edgeSum;  // edgeSum[t] = sum of v[s] * v[s + 1] for s < t
+    std::vector<int> left, right;    // Arc endpoints, left < right
+    std::vector<long long> lightest; // Lightest vertex strictly between the endpoints
+    std::vector<std::vector<int>> children; // Arcs directly below each arc, in polygon order
+
+    int size() const { return (int)left.size(); }
+    long long product(int arc) const { return v[left[arc]] * v[right[arc]]; }
+    //Sum of the side products along the polygon from an arc's left end to its right end
+    long long pathSum(int arc) const { return edgeSum[right[arc]] - edgeSum[left[arc]]; }
+    //True when the arc's fan apex is its left end (the root, whose ends are both V0, reports true)
+    bool apexOnLeft(int arc) const {
+        int a = left[arc], b = right[arc];
+        return b == (int)v.size() - 1 ? a == 0 : v[a] <= v[b];
+    }
+    long long apexWeight(int arc) const { return apexOnLeft(arc) ? v[left[arc]] : v[right[arc]]; }
+};
+
+//Rotates P so its lightest vertex comes first and finds every potential h-arc with one stack sweep
+inline PolygonArcs findPotentialArcs(const std::vector<int> &P) {
+    PolygonArcs arcs;
+    const int n = (int)P.size();
+    int lightest = 0;
+    for (int i = 1; i < n; ++i) {
+        if (P[i] < P[lightest]) lightest = i;
+    }
+    arcs.v.resize(n + 1);
+    for (int t = 0; t <= n; ++t) arcs.v[t] = P[(lightest + t) % n];
+    arcs.edgeSum.assign(n + 1, 0);
+    for (int t = 0; t < n; ++t) arcs.edgeSum[t + 1] = arcs.edgeSum[t] + arcs.v[t] * arcs.v[t + 1];
+
+    // Equal weights are ordered by position, which makes the polygon's weights distinct
+    const std::vector<long long> &v = arcs.v;
+    auto heavier = [&](int s, int t) { return v[s] > v[t] || (v[s] == v[t] && s > t); };
+    std::vector<int> stack{0}, pending;
+    auto addArc = [&](int a, int b, int inner) {
+        int arc = arcs.size();
+        arcs.left.push_back(a);
+        arcs.right.push_back(b);
+        arcs.lightest.push_back(v[inner]);
+        // Arcs found earlier that start inside [a, b] lie inside it and have no parent yet
+        std::vector<int> below;
+        while (!pending.empty() && arcs.left[pending.back()] >= a) {
+            below.push_back(pending.back());
+            pending.pop_back();
+        }
+        arcs.children.emplace_back(below.rbegin(), below.rend());
+        pending.push_back(arc);
+    };
+    for (int b = 1; b <= n; ++b) {
+        int popped = -1;
+        // v[n] stands for V0 and closes every arc still open
+        while (stack.size() > 1 && (b == n || heavier(stack.back(), b))) {
+            int t = stack.back();
+            stack.pop_back();
+            if (popped != -1) addArc(t, b, popped);
+            popped = t;
+        }
+        if (popped != -1) addArc(stack.back(), b, popped);
+        stack.push_back(b);
+    }
+    return arcs;
+}
+
+// --- Exact Solver ---
+
+/**
+ * @brief Supporting weight of an arc as the exact fraction num / den with den >= 0; den == 0
+ * stands for +infinity (an arc that is never kept).
+ */
+struct SupportingWeight {
+    long long num = 0;
+    long long den = 1;
+};
+
+inline bool heavierSupport(const SupportingWeight &a, const SupportingWeight &b) {
+    return (__int128)a.num * b.den > (__int128)b.num * a.den;
+}
+
+inline bool supportExceeds(const SupportingWeight &s, long long x) {
+    return (__int128)s.num > (__int128)x * s.den;
+}
+
+/**
+ * @brief Bookkeeping of the exact solver: per arc, the optimal cost of its sub-polygon, its
+ * supporting weight, the linear piece and heap of kept arcs it leaves behind, and its node in
+ * whichever heap currently holds it.
+ */
+struct HuShingState {
+    const PolygonArcs &arcs;
+    std::vector<long long> cost, slope, constant;
+    std::vector<SupportingWeight> support;
+    std::vector<int> frontier, heapLeft, heapRight, heapRank;
+    std::vector<int> firstLeft, firstRight; // Child sharing the arc's left / right end, or -1
+
+    explicit HuShingState(const PolygonArcs &polygon) : arcs(polygon) {
+        int m = arcs.size();
+        cost.assign(m, 0);
+        slope.assign(m, 0);
+        constant.assign(m, 0);
+        support.assign(m, SupportingWeight());
+        frontier.assign(m, -1);
+        heapLeft.assign(m, -1);
+        heapRight.assign(m, -1);
+        heapRank.assign(m, 1);
+        firstLeft.assign(m, -1);
+        firstRight.assign(m, -1);
+        for (int arc = 0; arc < m; ++arc) {
+            for (int child : arcs.children[arc]) {
+                if (arcs.left[child] == arcs.left[arc]) firstLeft[arc] = child;
+                if (arcs.right[child] == arcs.right[arc]) firstRight[arc] = child;
+            }
+        }
+    }
+
+    //Leftist-heap merge, heaviest supporting weight on top
+    int merge(int x, int y) {
+        if (x == -1) return y;
+        if (y == -1) return x;
+        if (heavierSupport(support[y], support[x])) std::swap(x, y);
+        heapRight[x] = merge(heapRight[x], y);
+        int l = heapLeft[x], r = heapRight[x];
+        if (l == -1 || (r != -1 && heapRank[l] < heapRank[r])) std::swap(heapLeft[x], heapRight[x]);
+        heapRank[x] = heapRight[x] == -1 ? 1 : heapRank[heapRight[x]] + 1;
+        return x;
+    }
+
+    //Drops the kept arc on top of 'heap': its sub-polygon joins the fan above, and the arcs it kept take its place
+    void dropTop(int &heap, long long &a, long long &k) {
+        int arc = heap;
+        a += slope[arc] - arcs.product(arc);
+        k += constant[arc] - cost[arc];
+        heap = merge(merge(heapLeft[arc], heapRight[arc]), frontier[arc]);
+    }
+
+    //Product of the kept arc or polygon side next to the apex at one end of 'arc', for an apex of weight x.
+    //Dropped arcs stay dropped as the apex gets lighter, so the chains are shortcut as they are walked.
+    long long touchingProduct(int arc, bool atLeft, long long x) {
+        std::vector<int> &next = atLeft ? firstLeft : firstRight;
+        int c = next[arc];
+        std::vector<int> walked;
+        while (c != -1 && supportExceeds(support[c], x)) {
+            walked.push_back(c);
+            c = next[c];
+        }
+        for (int w : walked) next[w] = c;
+        next[arc] = c;
+        if (c != -1) return arcs.product(c);
+        int t = atLeft ? arcs.left[arc] : arcs.right[arc] - 1;
+        return arcs.v[t] * arcs.v[t + 1];
+    }
+};
+
+/**
+ * @brief Minimum number of scalar multiplications for the chain with dimensions P (matrix i is
+ * P[i-1] x P[i]), the same optimum as the O(n^3) dynamic program, in O(n log n) time.
+ */
+inline long long huShingChainOrder(const std::vector<int> &P) {
+    if (P.size() <= 2) return 0;
+    PolygonArcs arcs = findPotentialArcs(P);
+    HuShingState state(arcs);
+
+    for (int arc = 0; arc < arcs.size(); ++arc) {
+        // Fan over the sub-polygon with every child arc kept, then drop those the apex cannot support
+        long long a = arcs.pathSum(arc), k = 0;
+        int heap = -1;
+        for (int child : arcs.children[arc]) {
+            a += arcs.product(child) - arcs.pathSum(child);
+            k += state.cost[child];
+            heap = state.merge(heap, child);
+        }
+        const long long x = arcs.apexWeight(arc);
+        while (heap != -1 && supportExceeds(state.support[heap], x)) state.dropTop(heap, a, k);
+
+        // The apex is a vertex of the sub-polygon: the side or arc touching it spans no triangle
+        if (arc == arcs.size() - 1) {
+            return a * x + k - x * (state.touchingProduct(arc, true, x) + state.touchingProduct(arc, false, x));
+        }
+        long long cost = a * x + k - x * state.touchingProduct(arc, arcs.apexOnLeft(arc), x);
+
+        // Supporting weight: where a * x + k meets product * x + cost, walking down the linear pieces
+        long long w = arcs.product(arc);
+        SupportingWeight support;
+        while (true) {
+            if (a > w) support = {cost - k, a - w};
+            else support = cost - k >= 0 ? SupportingWeight{1, 0} : SupportingWeight{0, 1};
+            if (heap == -1 || !heavierSupport(state.support[heap], support)) break;
+            state.dropTop(heap, a, k);
+        }
+        state.cost[arc] = cost;
+        state.slope[arc] = a;
+        state.constant[arc] = k;
+        state.support[arc] = support;
+        state.frontier[arc] = heap;
+    }
+    return 0;
+}
+
+// --- Approximate Solver ---
+
+/**
+ * @brief Cost of Hu and Shing's near-optimal partition for the chain with dimensions P: at most
+ * 2/sqrt(3) times the optimum, in O(n) time.
+ */
+inline long long approximateChainOrder(const std::vector<int> &P) {
+    if (P.size() <= 2) return 0;
+    PolygonArcs arcs = findPotentialArcs(P);
+    const int m = arcs.size();
+    const long long v0 = arcs.v[0];
+
+    // Every arc cuts off the triangle over its lightest inner vertex c once the arcs below it are cut.
+    // It is cut when the quadrilateral V0, Vi, c, Vj is cheaper split along Vi - Vj than along V0 - c;
+    // a vertex that stays becomes part of V0's fan, and so does everything around it.
+    std::vector<char> cut(m, 0);
+    long long triangles = 0;
+    for (int arc = 0; arc + 1 < m; ++arc) {
+        bool below = true;
+        for (int child : arcs.children[arc]) below = below && cut[child];
+        long long wi = arcs.v[arcs.left[arc]], wj = arcs.v[arcs.right[arc]], c = arcs.lightest[arc];
+        cut[arc] = below && (__int128)wi * wj * (v0 + c) < (__int128)v0 * c * (wi + wj);
+        if (cut[arc]) triangles += wi * wj * c;
+    }
+
+    // V0's fan spans the outermost cut arcs and the sides no cut arc covers, less those touching V0
+    long long fan = 0;
+    std::vector<int> open{m - 1};
+    while (!open.empty()) {
+        int arc = open.back();
+        open.pop_back();
+        fan += arcs.pathSum(arc);
+        for (int child : arcs.children[arc]) {
+            fan -= arcs.pathSum(child);
+            if (cut[child]) fan += arcs.product(child);
+            else open.push_back(child);
+        }
+    }
+    const int n = (int)arcs.v.size() - 1;
+    for (int end : {0, n}) {
+        // The outermost cut arc or side at V0 itself spans no triangle
+        long long touching = end == 0 ? v0 * arcs.v[1] : arcs.v[n - 1] * v0;
+        for (int arc = m - 1, next = -1; arc != -1; arc = next) {
+            next = -1;
+            for (int child : arcs.children[arc]) {
+                if ((end == 0 ? arcs.left[child] : arcs.right[child]) != end) continue;
+                if (cut[child]) touching = arcs.product(child);
+                else next = child;
+            }
+        }
+        fan -= touching;
+    }
+    return triangles + v0 * fan;
+}
+
+#endif
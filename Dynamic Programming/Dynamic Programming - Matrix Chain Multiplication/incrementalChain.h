@@ -0,0 +1,139 @@
+/**
+ * Matrix-chain ordering that follows a chain as it is edited, instead of re-solving it.
+ *
+ * The object keeps the whole dynamic-programming table in polygon form (cost(i, j) for
+ * vertices i < j, see chainTable.h), one row per vertex, together with the best split of every
+ * cell. The edits touch only the cells that depend on what changed:
+ *   pushBack      a new last vertex adds one column: O(n^2)
+ *   popFront      dropping the first vertex drops its row and nothing else: O(1)
+ *   setDimension  changing vertex v recomputes the cells (i, j) with i <= v <= j: O(v (n - v) n)
+ * Each recomputed cell scans its splits with row i and the column being built held in
+ * contiguous arrays.
+*/
+
+#ifndef MCM_INCREMENTAL_CHAIN_H
+#define MCM_INCREMENTAL_CHAIN_H
+
+#include <climits>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "chainExecutor.h"
+#include "chainTable.h"
+
+class IncrementalChainOrder {
+public:
+    IncrementalChainOrder() = default;
+
+    //Starts from the chain with dimensions P, solved in one go with the tiled table on 'threads' threads
+    explicit IncrementalChainOrder(const std::vector<int> &P, unsigned threads = 1) {
+        ChainTable table = solveChainTable(P, threads);
+        const int n = (int)P.size();
+        for (int i = 0; i < n; ++i) {
+            dims.push_back(P[i]);
+            costRows.emplace_back();
+            splitRows.emplace_back();
+            for (int j = i + 1; j < n; ++j) {
+                costRows[i].push_back(table.at(i, j));
+                splitRows[i].push_back(j > i + 1 ? table.splitAt(i, j) - i : 0);
+            }
+        }
+    }
+
+    int matrices() const { return dims.size() < 2 ? 0 : (int)dims.size() - 1; }
+    int vertices() const { return (int)dims.size(); }
+    const std::deque<long long>& dimensions() const { return dims; }
+
+    //Cheapest way to multiply matrices i..j-1 of the current chain (vertices i < j)
+    long long at(int i, int j) const { return costRows[i][j - i - 1]; }
+    //Split k of that cheapest way, (M_i..M_{k-1}) * (M_k..M_{j-1}); only meaningful for j > i + 1
+    int splitAt(int i, int j) const { return i + splitRows[i][j - i - 1]; }
+
+    //Minimum number of scalar multiplications for the whole chain
+    long long cost() const { return matrices() < 2 ? 0 : at(0, vertices() - 1); }
+
+    //Optimal bracketing of the whole chain
+    ChainPlan plan() const { return planFromTable(*this, vertices()); }
+
+    //Appends a dimension: the first call sets P[0], every later one appends a P.back() x dimension matrix
+    void pushBack(int dimension) {
+        dims.push_back(dimension);
+        costRows.emplace_back();
+        splitRows.emplace_back();
+        const int j = vertices() - 1;
+        if (j == 0) return;
+
+        std::vector<long long> flat(dims.begin(), dims.end()), column(j + 1, 0);
+        std::vector<int> splits(j + 1, 0);
+        for (int i = j - 1; i >= 0; --i) {
+            if (i < j - 1) solveCell(flat, i, j, column, splits);
+            costRows[i].push_back(column[i]);
+            splitRows[i].push_back(splits[i]);
+        }
+    }
+
+    //Drops the first matrix of the chain
+    void popFront() {
+        if (dims.empty()) throw std::runtime_error("Error: Cannot drop a matrix from an empty chain.");
+        dims.pop_front();
+        costRows.pop_front();
+        splitRows.pop_front();
+    }
+
+    //Sets P[index] of the current chain
+    void setDimension(int index, int dimension) {
+        if (index < 0 || index >= vertices()) {
+            throw std::runtime_error("Error: Dimension " + std::to_string(index) + " is outside a chain with " +
+                                     std::to_string(vertices()) + " dimensions.");
+        }
+        if (dims[index] == dimension) return;
+        dims[index] = dimension;
+
+        std::vector<long long> flat(dims.begin(), dims.end()), column(vertices(), 0);
+        std::vector<int> splits(vertices(), 0);
+        for (int j = std::max(index, 1); j < vertices(); ++j) {
+            // Cells (k, j) with k > index are untouched; the ones above them are recomputed bottom-up
+            for (int k = index + 1; k < j; ++k) column[k] = at(k, j);
+            for (int i = std::min(index, j - 1); i >= 0; --i) {
+                if (i == j - 1) {
+                    column[i] = 0;
+                    splits[i] = 0;
+                } else {
+                    solveCell(flat, i, j, column, splits);
+                }
+                costRows[i][j - i - 1] = column[i];
+                splitRows[i][j - i - 1] = splits[i];
+            }
+        }
+    }
+
+private:
+    std::deque<long long> dims;
+    std::deque<std::vector<long long>> costRows;  // costRows[i][j - i - 1] = cost(i, j)
+    std::deque<std::vector<int>> splitRows;       // splitRows[i][j - i - 1] = best split of (i, j) minus i
+
+    //Sets column[i] and splits[i] for cell (i, j), given column[k] = cost(k, j) for every i < k < j
+    void solveCell(const std::vector<long long> &flat, int i, int j, std::vector<long long> &column,
+                   std::vector<int> &splits) const {
+        // Split k = i + 1 + t: row[t] = cost(i, k), below[t] = cost(k, j), middle[t] = P[k]
+        const long long* row = costRows[i].data();
+        const long long* below = column.data() + i + 1;
+        const long long* middle = flat.data() + i + 1;
+        const long long outer = flat[i] * flat[j];
+        long long best = LLONG_MAX;
+        int bestSplit = 0;
+        for (int t = 0; t < j - i - 1; ++t) {
+            long long candidate = row[t] + below[t] + outer * middle[t];
+            if (candidate < best) {
+                best = candidate;
+                bestSplit = t;
+            }
+        }
+        column[i] = best;
+        splits[i] = bestSplit + 1;
+    }
+};
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * Entry points of the matrix-chain solvers, kept apart from mcm.cpp so that other programs,
+ * like the batch solver, can call them.
+ *
+ * matrixChainOrder() returns the minimum cost of a chain: short chains fill the tiled table of
+ * chainTable.h, long ones use the O(n log n) Hu-Shing solver of huShing.h, which gives the
+ * same answer. chainDimensions() turns the (rows, cols) pairs of an input file into the
+ * dimension array P.
+*/
+
+#ifndef MCM_MATRIX_CHAIN_H
+#define MCM_MATRIX_CHAIN_H
+
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "chainTable.h"
+#include "huShing.h"
+
+// Chains of at least this many matrices are ordered by the O(n log n) Hu-Shing solver instead of the O(n^3) table
+const int HU_SHING_MIN_MATRICES = 512;
+
+// Function to find the minimum number of scalar multiplications required
+// for matrix chain multiplication.
+// The dimensions array 'P' stores the dimensions of the matrices.
+// P[i-1] x P[i] are the dimensions of matrix Mi.
+// The table only stores the upper triangle, in tiles packed by diagonal, and the tiles
+// of each diagonal are filled in parallel on 'threads' threads (see chainTable.h).
+inline long long matrixChainOrder(const std::vector<int>& P, unsigned threads = 1) {
+    // 'n' is the number of elements in the dimension array P.
+    // The number of matrices is n - 1.
+    int n = P.size();
+    if (n <= 2) {
+        // 0 or 1 matrix (n=1 or n=2) requires 0 multiplications.
+        return 0;
+    }
+    if (n - 1 >= HU_SHING_MIN_MATRICES) return huShingChainOrder(P);
+
+    ChainTable table = solveChainTable(P, threads);
+
+    // The result is the minimum cost for multiplying the entire chain M_1...M_{n-1}
+    return table.at(0, n - 1);
+}
+
+//Builds P from the (row, col) pair of every matrix. Returns false and explains why in 'error' if
+//there are no matrices, a dimension is outside 1..INT_MAX or a matrix's rows do not match the
+//columns of the one before it.
+inline bool chainDimensions(const std::vector<int64_t>& numbers, std::vector<int>& P, std::string& error) {
+    P.clear();
+    for (size_t i = 0; i + 1 < numbers.size(); i += 2) {
+        for (size_t d = i; d < i + 2; ++d) {
+            if (numbers[d] < 1 || numbers[d] > INT_MAX) {
+                error = "Matrix " + std::to_string(i / 2 + 1) + " has the dimension " + std::to_string(numbers[d]) +
+                        ", which is not between 1 and " + std::to_string(INT_MAX);
+                return false;
+            }
+        }
+        int rows = (int)numbers[i], cols = (int)numbers[i + 1];
+        if (P.empty()) {
+            P.push_back(rows);
+        } else if (P.back() != rows) {
+            // 'rows' must match the last dimension (column) of the previous matrix
+            int matrix = (int)(i / 2) + 1;
+            error = "Matrix " + std::to_string(matrix - 1) + " column count (" + std::to_string(P.back()) +
+                    ") does not match Matrix " + std::to_string(matrix) + " row count (" + std::to_string(rows) + ")";
+            return false;
+        }
+        P.push_back(cols);
+    }
+    if (P.size() < 2) {
+        error = "Found incomplete matrix data or parsing failure. Ensure all matrices have (row, col) pairs";
+        return false;
+    }
+    return true;
+}
+
+#endif
@@ -4,154 +4,123 @@
 #include <climits>
 #include <fstream> 
 #include <string>  
-#include <sstream> // Added for string stream parsing
-#include <cctype>  // Added for isdigit
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#include "../../Common/fastInput.h"
+#include "chainExecutor.h"
+#include "incrementalChain.h"
+#include "matrixChain.h"
 
 using namespace std;
 
-// Function to find the minimum number of scalar multiplications required
-// for matrix chain multiplication.
-// The dimensions array 'P' stores the dimensions of the matrices.
-// P[i-1] x P[i] are the dimensions of matrix Mi.
-long long matrixChainOrder(const vector<int>& P) {
-    // 'n' is the number of elements in the dimension array P.
-    // The number of matrices is n - 1.
-    int n = P.size();
-    if (n <= 2) {
-        // 0 or 1 matrix (n=1 or n=2) requires 0 multiplications.
-        return 0;
+//Applies the edit script in 'editsFile' to the chain P with IncrementalChainOrder, one edit per line:
+//  push D     appends a P.back() x D matrix
+//  pop        drops the first matrix
+//  set I D    sets P[I] to D
+//Blank lines and lines starting with '#' are skipped. After every edit the cost is checked against a
+//full re-solve with planChainOrder. Returns the process exit code.
+int runEditScript(const vector<int> &P, const string &editsFile, unsigned threads) {
+    ifstream file(editsFile);
+    if (!file) {
+        cerr << "Error: Could not open edit script '" << editsFile << "'." << endl;
+        return 1;
     }
+    IncrementalChainOrder chain(P, threads);
+    double incrementalSeconds = 0, resolveSeconds = 0;
+    int edits = 0, lineNumber = 0;
+    string line;
+    while (getline(file, line)) {
+        ++lineNumber;
+        istringstream in(line);
+        string op;
+        if (!(in >> op) || op[0] == '#') continue;
+        int index = 0, dimension = 0;
+        bool valid = op == "pop" || (op == "push" && in >> dimension) || (op == "set" && in >> index >> dimension);
+        string rest;
+        if (!valid || in >> rest || (op != "pop" && dimension <= 0)) {
+            cerr << "Error: Line " << lineNumber << " of " << editsFile << " is not 'push D', 'pop' or 'set I D' with D > 0: " << line << endl;
+            return 1;
+        }
 
-    // dp[i][j] will store the minimum number of scalar multiplications
-    // needed to compute the matrix chain product M_i * ... * M_j.
-    // We use long long for costs to avoid overflow.
-    vector<vector<long long>> dp(n, vector<long long>(n, 0));
-
-    // L is the chain length (number of matrices being multiplied)
-    // L goes from 2 up to n-1 (the total number of matrices)
-    for (int L = 2; L < n; L++) {
-        // i is the starting matrix index (from 1 to n - L)
-        for (int i = 1; i <= n - L; i++) {
-            // j is the ending matrix index
-            int j = i + L - 1;
-
-            // Initialize the current minimum cost to a very large number
-            dp[i][j] = LLONG_MAX;
-
-            // Try every possible split point k (i <= k < j)
-            // (M_i ... M_k) * (M_{k+1} ... M_j)
-            for (int k = i; k <= j - 1; k++) {
-                // Cost = (Cost of M_i..M_k) + (Cost of M_{k+1}..M_j) + (Cost of final multiplication)
-                
-                // P[i-1] x P[k] are the dimensions of the resultant of the first part (M_i..M_k)
-                // P[k] x P[j] are the dimensions of the resultant of the second part (M_{k+1}..M_j)
-                long long current_cost = dp[i][k] + dp[k + 1][j] + (long long)P[i - 1] * P[k] * P[j];
-
-                // Update the minimum cost for this subproblem
-                dp[i][j] = min(dp[i][j], current_cost);
-            }
+        auto start = chrono::steady_clock::now();
+        try {
+            if (op == "push") chain.pushBack(dimension);
+            else if (op == "pop") chain.popFront();
+            else chain.setDimension(index, dimension);
+        } catch (const runtime_error &e) {
+            cerr << e.what() << " (line " << lineNumber << " of " << editsFile << ")" << endl;
+            return 1;
+        }
+        long long cost = chain.cost();
+        auto edited = chrono::steady_clock::now();
+        vector<int> current(chain.dimensions().begin(), chain.dimensions().end());
+        long long expected = chain.matrices() < 2 ? 0 : planChainOrder(current, threads).cost;
+        auto resolved = chrono::steady_clock::now();
+        incrementalSeconds += chrono::duration<double>(edited - start).count();
+        resolveSeconds += chrono::duration<double>(resolved - edited).count();
+        ++edits;
+
+        cout << "Edit " << edits << " (" << line << "): " << chain.matrices() << " matrices, minimum cost " << cost << endl;
+        if (cost != expected) {
+            cerr << "Error: The incremental cost " << cost << " differs from the re-solved cost " << expected << "." << endl;
+            return 1;
         }
     }
-
-    // The result is the minimum cost for multiplying the entire chain M_1...M_{n-1}
-    return dp[1][n - 1];
+    cout << "All " << edits << " edits match a full re-solve. Incremental updates took " << incrementalSeconds
+         << " s, re-solving after every edit " << resolveSeconds << " s." << endl;
+    return 0;
 }
 
-int progRunner(const string filename) {
-    
-}
-
-int main() {
-    const string filename = "examaple.txt";
-    ifstream inputFile(filename);
-
+//Solves the chain in 'filename' and prints its cost and, unless it is approximated, its order.
+//'execute' also multiplies random matrices of these shapes in that order on 'threads' threads.
+//A non-empty 'editsFile' then applies that edit script to the chain (see runEditScript).
+//Returns the process exit code.
+int progRunner(const string filename, bool approximate = false, bool execute = false, unsigned threads = 1,
+               const string &editsFile = "") {
     cout << "--- Matrix Chain Multiplication Solver ---" << endl;
     cout << "Attempting to read dimensions from file: " << filename << endl;
 
-    if (!inputFile.is_open()) {
-        cerr << "Error: Could not open file " << filename << ". Please ensure the file exists in the same directory." << endl;
+    // Read every number in the file; braces, commas and whitespace only separate them
+    vector<int64_t> numbers;
+    string error;
+    if (!readIntegerList(filename, numbers, error)) {
+        cerr << "Error: " << error << ". Please ensure the file exists in the same directory." << endl;
         return 1; 
     }
 
-    // Read the entire file content into a single string
-    string fileContent;
-    fileContent.assign((istreambuf_iterator<char>(inputFile)),
-                       (istreambuf_iterator<char>()));
-    
-    inputFile.close();
-
-    // --- Data Cleaning and Pre-processing ---
-    string cleanContent;
-    for (char c : fileContent) {
-        if (isdigit(c)) {
-            cleanContent += c;
-        } else if (c == ',') {
-            // Replace commas with spaces to act as delimiters
-            cleanContent += ' ';
-        } else if (c == ' ' || c == '\n' || c == '\r') {
-            // Preserve delimiters but ensure no double spaces
-            if (!cleanContent.empty() && cleanContent.back() != ' ') {
-                cleanContent += ' ';
-            }
-        }
-        // Braces {}, tabs, and other characters are ignored
-    }
-    
-    // Trim potential leading/trailing spaces
-    size_t first = cleanContent.find_first_not_of(' ');
-    size_t last = cleanContent.find_last_not_of(' ');
-    if (string::npos != first && string::npos != last) {
-        cleanContent = cleanContent.substr(first, (last - first + 1));
-    } else {
-        cleanContent = ""; 
-    }
-    
-    // Check for empty content after cleaning
-    if (cleanContent.empty()) {
+    // Check for empty content
+    if (numbers.empty()) {
         cerr << "Error: File '" << filename << "' is empty or contains only non-numeric delimiters. Cannot process." << endl;
         return 1;
     }
-    
-    // Use stringstream to parse the cleaned, space-separated numbers
-    stringstream ss_parser(cleanContent);
 
-    vector<int> P; // The dimension array (e.g., {5, 5, 10, 13, 10})
-    int row_dim, col_dim;
-    int matrixCount = 0;
-    
-    // Read the (row, col) pairs from the string stream
-    while (ss_parser >> row_dim >> col_dim) {
-        matrixCount++;
-        if (P.empty()) {
-            // First matrix: M1 (row x col) -> P = {row, col}
-            P.push_back(row_dim);
-            P.push_back(col_dim);
-            cout << "M" << matrixCount << ": " << row_dim << "x" << col_dim;
-        } else {
-            // Subsequent matrices: Mi (row x col)
-            // 'row' must match the last dimension (column) of the previous matrix.
-            if (P.back() != row_dim) {
-                cerr << "\nValidation Error in file " << filename << ": Matrix " << (matrixCount - 1) << " column count (" << P.back() 
-                     << ") does not match Matrix " << matrixCount << " row count (" << row_dim << ")." << endl;
-                cerr << "Chain is invalid. Exiting this run." << endl;
-                return 1;
-            }
-            // Append only 'col' to P, as 'row' is a duplicate of P.back()
-            P.push_back(col_dim);
-            cout << ", M" << matrixCount << ": " << row_dim << "x" << col_dim;
-        }
+    // The dimension array (e.g., {5, 5, 10, 13, 10}) from the (row, col) pairs
+    vector<int> P;
+    if (!chainDimensions(numbers, P, error)) {
+        cerr << "\nValidation Error in file " << filename << ": " << error << "." << endl;
+        cerr << "Chain is invalid. Exiting this run." << endl;
+        return 1;
+    }
+    int matrixCount = (int)P.size() - 1;
+    for (int i = 1; i <= matrixCount; ++i) {
+        cout << (i > 1 ? ", M" : "M") << i << ": " << P[i - 1] << "x" << P[i];
     }
     cout << endl; 
 
-    // Final check for parsing failure/incomplete data
-    if (P.size() < 2) {
-        cerr << "\nError in file " << filename << ": Found incomplete matrix data or parsing failure. Ensure all matrices have (row, col) pairs." << endl;
-        return 1;
+    // Call the solver function: the table (which also gives the order) for short chains, Hu-Shing for long ones
+    long long min_multiplications;
+    ChainPlan plan;
+    if (approximate) min_multiplications = approximateChainOrder(P);
+    else if (matrixCount >= HU_SHING_MIN_MATRICES && !execute) min_multiplications = matrixChainOrder(P);
+    else {
+        plan = planChainOrder(P, threads);
+        min_multiplications = plan.cost;
     }
 
-    // Call the solver function
-    long long min_multiplications = matrixChainOrder(P);
-
     cout << "\nInput Dimensions (P array): [";
     for (size_t i = 0; i < P.size(); ++i) {
         cout << P[i] << (i == P.size() - 1 ? "" : ", ");
@@ -159,13 +128,76 @@ int main() {
     cout << "]" << endl;
 
     cout << "Total number of matrices processed: " << matrixCount << endl;
-    cout << "Minimum number of single-register multiplications required: " << min_multiplications << endl;
+    if (approximate) {
+        cout << "Near-minimum number of single-register multiplications (at most 2/sqrt(3) times the minimum): " << min_multiplications << endl;
+    } else {
+        cout << "Minimum number of single-register multiplications required: " << min_multiplications << endl;
+        if (!plan.nodes.empty()) cout << "Optimal parenthesization: " << chainParenthesization(plan) << endl;
+    }
+
+    if (execute) {
+        if (plan.nodes.empty()) plan = planChainOrder(P, threads);
+        // Only the shapes come from the file, so the matrices get random entries; working modulo
+        // a prime keeps a long product exact instead of overflowing
+        using Element = ModInt<998244353>;
+        mt19937 rng(12345);
+        vector<Matrix<Element>> chain;
+        for (int i = 0; i < matrixCount; ++i) {
+            Matrix<Element> matrix(P[i], P[i + 1]);
+            for (Element &entry : matrix.data) entry = Element(rng());
+            chain.push_back(move(matrix));
+        }
+        StrassenOptions options;
+        options.threads = threads;
+        auto start = chrono::steady_clock::now();
+        Matrix<Element> product = multiplyChain(chain, plan, options);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        Element sum = 0;
+        for (Element entry : product.data) sum += entry;
+        cout << "Executed the chain in the optimal order in " << seconds << " s: the product is " << product.rows << "x"
+             << product.cols << " with entry sum " << sum << " (mod " << Element::MODULUS << ")" << endl;
+    }
     
     // Check against the known example result
     if (matrixCount == 4 && min_multiplications == 1550) {
         cout << "Result matches the expected example answer (1550) for the input file." << endl;
     }
+    if (!editsFile.empty()) return runEditScript(P, editsFile, threads);
 
     return 0; // Success
 
 }
+
+//Usage: mcm [--approximate] [--threads N] [--execute] [--edits SCRIPT] [file]
+//         --approximate: O(n) order within 2/sqrt(3) of the optimum
+//         --execute:     multiply random matrices of these shapes in the optimal order
+//         --edits:       follow the chain through an edit script, checking each step against a re-solve
+//       mcm --to-binary input output   (binary inputs load without parsing)
+int main(int argc, char* argv[]) {
+    if (argc == 4 && string(argv[1]) == "--to-binary") {
+        string error;
+        if (!convertIntegerListToBinary(argv[2], argv[3], error)) {
+            cerr << "Error: " << error << endl;
+            return 1;
+        }
+        return 0;
+    }
+    string filename = "example.txt";
+    string editsFile;
+    bool approximate = false, execute = false;
+    unsigned threads = 1;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--approximate") approximate = true;
+        else if (arg == "--execute") execute = true;
+        else if (arg == "--threads" && i + 1 < argc) {
+            int count = 0;
+            if (!parseNumber(argv[++i], count)) return badFlagValue(arg, argv[i]);
+            threads = max(1, count);
+        }
+        else if (arg == "--edits" && i + 1 < argc) editsFile = argv[++i];
+        else filename = arg;
+    }
+
+    return progRunner(filename, approximate, execute, threads, editsFile);
+}
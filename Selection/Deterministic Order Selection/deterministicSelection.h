@@ -0,0 +1,280 @@
+/**
+ * Deterministic order selection: the k-th smallest element of an array in worst-case linear
+ * time, pivoting on the median of the medians of groups of five. The partition sets the keys
+ * equal to the pivot apart, which keeps the bound on heavily duplicated data too.
+ *
+ * introselect() gets the same answer several times faster on typical data by pivoting on a
+ * sampled estimate, and only falls back to the median of medians when that stops making
+ * progress. Both work in place, without allocating.
+ *
+ * multi_select() finds several ranks at once, such as a batch of percentiles, splitting the
+ * array once per rank instead of selecting each one on a fresh copy.
+ *
+ * Kept apart from deterministicOrderSelection.cpp so that other programs, like the batch solver,
+ * can call it.
+*/
+
+#ifndef SELECTION_DETERMINISTIC_SELECTION_H
+#define SELECTION_DETERMINISTIC_SELECTION_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+//Uses insertion sort to sort smaller sized vectors to find the k-th element
+inline void insertion_sort(std::vector<int>& arr, int left, int right) {
+    for (int i = left + 1; i <= right; ++i) {
+        int key = arr[i];
+        int j = i - 1;
+
+        //Shift elements greater than key to the right
+        while (j >= left && arr[j] > key) {
+            arr[j + 1] = arr[j];
+            j = j - 1;
+        }
+
+        arr[j + 1] = key;
+    }
+}
+
+//Function is used to find the median of each group of 5
+inline int find_and_move_median(std::vector<int>& arr, int left, int right) {
+    //Sorts the group using Insertion Sort
+    insertion_sort(arr, left, right);
+    
+    //Calculates the median index
+    int median_idx = left + (right - left) / 2;
+    
+    //The value at median_idx is the median of this group
+    return arr[median_idx];
+}
+
+//Function used to partition around a specific pivot value into three parts: smaller, equal and larger.
+//Returns the first and last index of the equal part, which is never empty when the pivot is in the range.
+//Both passes are branchless: every element is stored to the front of the part being grown and the
+//end of that part moves by the comparison's result, so duplicated data costs no mispredictions.
+inline std::pair<int, int> three_way_partition(std::vector<int>& arr, int left, int right, int pivot_value) {
+    //Pass 1: the elements smaller than the pivot to the front
+    int less_end = left;
+    for (int j = left; j <= right; ++j) {
+        int value = arr[j];
+        arr[j] = arr[less_end];
+        arr[less_end] = value;
+        less_end += value < pivot_value;
+    }
+
+    //Pass 2: among the rest (none smaller), the elements equal to the pivot to the front
+    int equal_end = less_end;
+    for (int j = less_end; j <= right; ++j) {
+        int value = arr[j];
+        arr[j] = arr[equal_end];
+        arr[equal_end] = value;
+        equal_end += value == pivot_value;
+    }
+
+    return {less_end, equal_end - 1};
+}
+
+inline int deterministic_select(std::vector<int>& arr, int left, int right, int k);
+
+//Function finds the median of medians of [left, right] in place: the median of each group of 5
+//is swapped to the front of the range, and the median of those is selected where they are
+inline int median_of_medians_pivot(std::vector<int>& arr, int left, int right) {
+    //Total number of elements in the current sub-array
+    int n = right - left + 1;
+    
+    //Calculates the number of groups
+    int num_groups = (n + 4) / 5;
+
+    //Iterates through the vector in groups of 5
+    for (int i = 0; i < num_groups; ++i) {
+        int group_start = left + i * 5;
+        int group_end = std::min(group_start + 4, right);
+        
+        //Sorts the group; its median moves to position left + i, which belongs to a group already done
+        find_and_move_median(arr, group_start, group_end);
+        std::swap(arr[left + i], arr[group_start + (group_end - group_start) / 2]);
+    }
+
+    //Recursively finds the Median of Medians among the medians now at [left, left + num_groups - 1]
+    return deterministic_select(arr, left, left + num_groups - 1, (num_groups + 1) / 2);
+}
+
+//Function finds the k-th smallest element (where k is 1-based rank) given a vector "arr"
+inline int deterministic_select(std::vector<int>& arr, int left, int right, int k) {
+    // k is the 1-based rank we are looking for
+    while (true) {
+        //Base case: a single group of 5 or fewer is simply sorted
+        if (right - left < 5) {
+            insertion_sort(arr, left, right);
+            return arr[left + k - 1];
+        }
+
+        //Step 1 and 2: Finds the Median of Medians which will be used as the pivot value
+        int mom_pivot = median_of_medians_pivot(arr, left, right);
+
+        //Step 3: Partition the original array around the MoM pivot; keys equal to it are set apart,
+        //so however duplicated the data, each side keeps at most about 7/10 of the range
+        std::pair<int, int> equal = three_way_partition(arr, left, right, mom_pivot);
+
+        //Calculate the ranks of the first and last pivot copies in the current sub-array (1-based)
+        int first_rank = equal.first - left + 1;
+        int last_rank = equal.second - left + 1;
+
+        //Step 4: Check the pivot ranks and continue in the part holding the k-th element
+        if (k < first_rank) {
+            //The k-th element is in the left partition
+            right = equal.first - 1;
+        } else if (k <= last_rank) {
+            //The k-th element is one of the copies of the pivot
+            return mom_pivot;
+        } else {
+            //The k-th element is in the right partition. We look for the (k - last_rank)-th element in the right partition.
+            left = equal.second + 1;
+            k -= last_rank;
+        }
+    }
+}
+
+// --- Introselect ---
+
+//Ranges up to this size are finished with insertion sort
+const int INTROSELECT_SORT_SIZE = 24;
+//Ranges above this size take their pivot from a Floyd-Rivest sample
+const int FLOYD_RIVEST_MIN_SIZE = 600;
+
+/**
+ * @brief Finds the k-th smallest element (1-based rank k) of [left, right] like
+ * deterministic_select, but pivots on a cheap estimate first: for large ranges the element of
+ * the right rank in a sample of about n^(2/3) elements around position k (Floyd-Rivest,
+ * selected recursively in place), for smaller ones the median of the first, middle and last
+ * element. These usually leave far fewer than n/4 elements in play. Whenever a partition keeps
+ * more than 3/4 of the range, progress has stalled (adversarial order) and the rest is left to
+ * the median of medians, so the worst case stays linear.
+ */
+inline int introselect(std::vector<int>& arr, int left, int right, int k) {
+    int target = left + k - 1; // Absolute position of the k-th smallest element
+    while (right - left + 1 > INTROSELECT_SORT_SIZE) {
+        int n = right - left + 1;
+
+        //Step 1: Estimates the pivot
+        int pivot;
+        if (n > FLOYD_RIVEST_MIN_SIZE) {
+            //The sample [sample_left, sample_right] holds position 'target' at the same relative rank,
+            //widened by a few standard deviations towards the middle
+            int i = target - left + 1;
+            double z = std::log((double)n);
+            double s = 0.5 * std::exp(2 * z / 3);
+            double sd = 0.5 * std::sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1 : 1);
+            int sample_left = std::max(left, (int)(target - i * s / n + sd));
+            int sample_right = std::min(right, (int)(target + (n - i) * s / n + sd));
+            pivot = introselect(arr, sample_left, sample_right, target - sample_left + 1);
+        } else {
+            int a = arr[left], b = arr[left + (right - left) / 2], c = arr[right];
+            pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+        }
+
+        //Step 2: Partition around it and keep the part holding position 'target'
+        std::pair<int, int> equal = three_way_partition(arr, left, right, pivot);
+        if (target < equal.first) {
+            right = equal.first - 1;
+        } else if (target > equal.second) {
+            left = equal.second + 1;
+        } else {
+            return pivot;
+        }
+
+        //Step 3: Falls back to the median of medians if the estimate did not pay off
+        if (right - left + 1 > n - n / 4) return deterministic_select(arr, left, right, target - left + 1);
+    }
+    insertion_sort(arr, left, right);
+    return arr[target];
+}
+
+// --- Multi-Rank Selection ---
+
+//Fills values[i] for ranks[i] with i in [first, last), all of which lie in [left, right]
+inline void multi_select_range(std::vector<int>& arr, int left, int right, const std::vector<int>& ranks, int first,
+                               int last, std::vector<int>& values) {
+    while (first < last) {
+        //Selects the middle requested rank; like every partition-based selection, introselect leaves
+        //the smaller elements before its position and the larger ones after it
+        int middle = first + (last - first) / 2;
+        int target = ranks[middle] - 1;
+        int value = introselect(arr, left, right, target - left + 1);
+
+        //Every request for the same rank gets the same value
+        int low = middle, high = middle + 1;
+        while (low > first && ranks[low - 1] == ranks[middle]) --low;
+        while (high < last && ranks[high] == ranks[middle]) ++high;
+        for (int i = low; i < high; ++i) values[i] = value;
+
+        //Only the sides that still hold requested ranks are searched, the larger one in this loop
+        if (low - first < last - high) {
+            multi_select_range(arr, left, target - 1, ranks, first, low, values);
+            left = target + 1;
+            first = high;
+        } else {
+            multi_select_range(arr, target + 1, right, ranks, high, last, values);
+            right = target - 1;
+            last = low;
+        }
+    }
+}
+
+/**
+ * @brief Finds the elements of several 1-based ranks of arr at once, in place. 'ranks' must be
+ * sorted; the result holds the element of each rank in the same order. One selection places
+ * the middle rank and splits the array around it, and each side is searched only for the ranks
+ * it holds, so q ranks cost O(n log q) rather than q separate selections on fresh copies.
+ */
+inline std::vector<int> multi_select(std::vector<int>& arr, const std::vector<int>& ranks) {
+    for (size_t i = 0; i < ranks.size(); ++i) {
+        if (ranks[i] < 1 || ranks[i] > (int)arr.size()) {
+            throw std::runtime_error("Error: Invalid rank " + std::to_string(ranks[i]) + ". Must be between 1 and " +
+                                     std::to_string(arr.size()) + ".");
+        }
+        if (i > 0 && ranks[i] < ranks[i - 1]) throw std::runtime_error("Error: The ranks must be sorted.");
+    }
+    std::vector<int> values(ranks.size());
+    multi_select_range(arr, 0, (int)arr.size() - 1, ranks, 0, (int)ranks.size(), values);
+    return values;
+}
+
+//Nearest ranks of the given percentiles (0 to 100, sorted) among n elements, ready for multi_select
+inline std::vector<int> percentile_ranks(int n, const std::vector<double>& percentiles) {
+    std::vector<int> ranks;
+    for (double percentile : percentiles) {
+        int rank = (int)std::ceil(percentile / 100 * n);
+        ranks.push_back(std::min(std::max(rank, 1), n));
+    }
+    return ranks;
+}
+
+//Splits the numbers of an input file into the rank k and the array. Returns false and explains why
+//in 'error' if there is no k or an element does not fit in int, instead of truncating it; k itself
+//stays 64 bits wide so that the caller's range check sees its real value.
+inline bool selection_input(const std::vector<int64_t>& numbers, int64_t& k, std::vector<int>& data, std::string& error) {
+    if (numbers.empty()) {
+        error = "Failed to read k (the target rank)";
+        return false;
+    }
+    k = numbers[0];
+    data.clear();
+    data.reserve(numbers.size() - 1);
+    for (size_t i = 1; i < numbers.size(); ++i) {
+        if (numbers[i] < INT_MIN || numbers[i] > INT_MAX) {
+            error = "Element " + std::to_string(i) + " (" + std::to_string(numbers[i]) + ") does not fit in a 32-bit int";
+            return false;
+        }
+        data.push_back((int)numbers[i]);
+    }
+    return true;
+}
+
+#endif